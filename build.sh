@@ -40,6 +40,19 @@ else
     echo ">> SDRPlay disabled (Dummy Mode)."
 fi
 
+# --- FIXED POINT PROMPT ---
+echo "------------------------------------------"
+echo "Use the fixed-point (Q15) NFM path?"
+echo "Recommended on Raspberry Pi / ARM boards (NEON)."
+read -p "Enable fixed point? [y/N]: " response
+
+if [[ "$response" =~ ^([yY][eE][sS]|[yY])+$ ]]; then
+    echo ">> Fixed-point NFM enabled."
+    SDR_FLAGS="$SDR_FLAGS -DENABLE_FIXED_POINT"
+else
+    echo ">> Floating-point DSP."
+fi
+
 echo "------------------------------------------"
 echo "Compiling..."
 
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+// Audio AGC settings. Level is peak based: the output peaks settle at targetLevel.
+struct AgcSettings {
+    bool enabled = true;
+    float targetLevel = 0.3f;
+    float attackMs = 1.0f;    // envelope rise
+    float decayMs = 300.0f;   // envelope fall, after the hang time
+    float hangMs = 200.0f;    // gain held after a peak, so speech pauses don't pump up the noise
+    float maxGainDb = 50.0f;
+
+    bool operator==(const AgcSettings& o) const {
+        return enabled == o.enabled && targetLevel == o.targetLevel && attackMs == o.attackMs
+            && decayMs == o.decayMs && hangMs == o.hangMs && maxGainDb == o.maxGainDb;
+    }
+};
+
+// Block AGC with attack / decay / hang. The envelope is updated once per CHUNK samples from
+// the chunk's peak, and the gain ramps linearly across the chunk, so the per-sample work is a
+// max and a multiply-add the compiler vectorizes. Each Demodulator owns one.
+class Agc {
+public:
+    static constexpr size_t CHUNK = 32;
+    AgcSettings settings;
+
+    void reset() { envelope = 0.0f; gain = 1.0f; hangLeft = 0.0f; }
+
+    // In place; with `right` both channels get the same gain (from the louder one)
+    void process(float* left, float* right, size_t count, double sampleRate) {
+        if (!settings.enabled) return;
+        const float chunkMs = (float)(1000.0 * CHUNK / sampleRate);
+        const float attack = 1.0f - std::exp(-chunkMs / std::max(settings.attackMs, 1e-3f));
+        const float decay = 1.0f - std::exp(-chunkMs / std::max(settings.decayMs, 1e-3f));
+        const float maxGain = std::pow(10.0f, settings.maxGainDb / 20.0f);
+
+        for (size_t start = 0; start < count; start += CHUNK) {
+            size_t n = std::min(CHUNK, count - start);
+            float* l = left + start;
+            float* r = right ? right + start : nullptr;
+
+            float peak = 0.0f;
+            for (size_t i = 0; i < n; i++) peak = std::max(peak, std::fabs(l[i]));
+            if (r) for (size_t i = 0; i < n; i++) peak = std::max(peak, std::fabs(r[i]));
+
+            if (peak > envelope) {
+                envelope += attack * (peak - envelope);
+                hangLeft = settings.hangMs;
+            } else if (hangLeft > 0.0f) {
+                hangLeft -= chunkMs;
+            } else {
+                envelope += decay * (peak - envelope);
+            }
+
+            float target = std::min(settings.targetLevel / std::max(envelope, 1e-9f), maxGain);
+            float step = (target - gain) / n;
+            for (size_t i = 0; i < n; i++) l[i] *= gain + step * (i + 1);
+            if (r) for (size_t i = 0; i < n; i++) r[i] *= gain + step * (i + 1);
+            gain = target;
+        }
+    }
+
+private:
+    float envelope = 0.0f;
+    float gain = 1.0f;
+    float hangLeft = 0.0f; // ms
+};
@@ -2,10 +2,10 @@
 
 #include <vector>
 #include <mutex>
-#include <deque>
 #include <string>
 #include <algorithm>
 #include "miniaudio.h"
+#include "RingBuffer.h"
 
 class AudioSink {
 public:
@@ -14,8 +14,13 @@ public:
         ma_device_id id;
     };
 
-    std::mutex mutex;
-    std::deque<float> sampleQueue;
+    // One interleaved output frame; the device always plays stereo, mono is duplicated
+    struct StereoFrame {
+        float left, right;
+    };
+
+    // Preallocated (~2.7 s at 48 kHz); on overflow the oldest frames are dropped
+    RingBuffer<StereoFrame> sampleQueue;
     
     ma_context context;
     ma_device device;
@@ -24,7 +29,7 @@ public:
     
     std::vector<DeviceInfo> availableDevices;
 
-    AudioSink() {
+    AudioSink() : sampleQueue(1 << 17) {
         if (ma_context_init(NULL, 0, NULL, &context) != MA_SUCCESS) return;
         refreshDeviceList();
     }
@@ -57,7 +62,7 @@ public:
 
         config = ma_device_config_init(ma_device_type_playback);
         config.playback.format   = ma_format_f32;
-        config.playback.channels = 1;
+        config.playback.channels = 2;
         config.sampleRate        = sampleRate;
         config.dataCallback      = data_callback;
         config.pUserData         = this;
@@ -80,34 +85,42 @@ public:
         if (isInitialized) ma_device_stop(&device); 
     }
 
-    void pushSamples(const std::vector<float>& audioData) {
-        std::lock_guard<std::mutex> lock(mutex);
-        sampleQueue.insert(sampleQueue.end(), audioData.begin(), audioData.end());
+    // Mono: the same sample on both channels
+    void pushSamples(const float* audioData, size_t count) {
+        StereoFrame chunk[256];
+        for (size_t i = 0; i < count;) {
+            size_t n = std::min(count - i, (size_t)256);
+            for (size_t j = 0; j < n; j++) chunk[j] = {audioData[i + j], audioData[i + j]};
+            sampleQueue.push(chunk, n);
+            i += n;
+        }
+    }
+
+    void pushStereo(const float* left, const float* right, size_t count) {
+        StereoFrame chunk[256];
+        for (size_t i = 0; i < count;) {
+            size_t n = std::min(count - i, (size_t)256);
+            for (size_t j = 0; j < n; j++) chunk[j] = {left[i + j], right[i + j]};
+            sampleQueue.push(chunk, n);
+            i += n;
+        }
     }
 
+    // Buffered frames
     size_t getBufferedCount() {
-        std::lock_guard<std::mutex> lock(mutex);
-        return sampleQueue.size();
+        return sampleQueue.available();
     }
     
     void clear() {
-        std::lock_guard<std::mutex> lock(mutex);
         sampleQueue.clear();
     }
 
 private:
     static void data_callback(ma_device* pDevice, void* pOutput, const void* pInput, ma_uint32 frameCount) {
         AudioSink* sink = (AudioSink*)pDevice->pUserData;
-        float* out = (float*)pOutput;
-        std::lock_guard<std::mutex> lock(sink->mutex);
+        StereoFrame* out = (StereoFrame*)pOutput;
         
-        for (ma_uint32 i = 0; i < frameCount; ++i) {
-            if (!sink->sampleQueue.empty()) {
-                out[i] = sink->sampleQueue.front();
-                sink->sampleQueue.pop_front();
-            } else {
-                out[i] = 0.0f;
-            }
-        }
+        size_t got = sink->sampleQueue.pop(out, frameCount);
+        std::fill(out + got, out + frameCount, StereoFrame{0.0f, 0.0f});
     }
 };
\ No newline at end of file
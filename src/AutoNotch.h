@@ -0,0 +1,171 @@
+#pragma once
+
+#include "DSP.h"
+#include "FilterDesign.h"
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+// Automatic notch settings: up to maxNotches steady tones are removed, each with a notch
+// widthHz wide (-3 dB).
+struct AutoNotchSettings {
+    bool enabled = false;
+    int maxNotches = 4;
+    float widthHz = 40.0f;
+
+    bool operator==(const AutoNotchSettings& o) const {
+        return enabled == o.enabled && maxNotches == o.maxNotches && widthHz == o.widthHz;
+    }
+};
+
+// Heterodyne remover for AM / SSB audio. The input is analyzed in ~40 ms frames (RealFFTPlan,
+// Hann window, power averaged over frames); a bin counts as a carrier when it stands
+// PEAK_DB above its neighbourhood for STEADY_FRAMES frames in a row. Speech harmonics move
+// and don't qualify. The strongest carriers (frequency refined by parabolic interpolation)
+// get a Biquad notch each; notches follow drifting carriers without clicks and are released
+// once their carrier has been gone for a few frames.
+// Analysis is one FFT per frame, the audio path at most MAX_NOTCHES biquads per sample.
+class AutoNotch {
+public:
+    static constexpr int MAX_NOTCHES = 8;
+    AutoNotchSettings settings;
+
+    void reset() {
+        fill = 0;
+        std::fill(average.begin(), average.end(), 0.0);
+        std::fill(steady.begin(), steady.end(), 0);
+        for (Slot& s : slots) s.active = false;
+    }
+
+    // Active notch frequencies (Hz) into out, returns their count
+    int notches(float* out) const {
+        int n = 0;
+        for (const Slot& s : slots) if (s.active) out[n++] = (float)s.freqHz;
+        return n;
+    }
+
+    // In place
+    void process(float* audio, size_t count, double sampleRate) {
+        if (sampleRate != rate) setRate(sampleRate);
+        for (size_t i = 0; i < count; i++) {
+            frameBuf[fill] = audio[i];
+            if (++fill == frame) { analyze(); fill = 0; }
+            float x = audio[i];
+            for (Slot& s : slots) if (s.active) x = s.filter.process(x);
+            audio[i] = x;
+        }
+    }
+
+private:
+    static constexpr double PEAK_DB = 15.0;
+    static constexpr int STEADY_FRAMES = 4;
+    static constexpr int RELEASE_FRAMES = 3;
+
+    struct Slot {
+        bool active = false;
+        double freqHz = 0.0;
+        int missing = 0;
+        Biquad filter;
+    };
+
+    double rate = 0.0;
+    size_t frame = 2048, fill = 0;
+    RealFFTPlan plan;
+    std::vector<double> window, frameBuf, work;
+    std::vector<Complex> spec;
+    std::vector<double> average;
+    std::vector<int> steady, steadyNext;
+    Slot slots[MAX_NOTCHES];
+
+    void setRate(double sampleRate) {
+        rate = sampleRate;
+        frame = 16;
+        while (frame < 0.04 * rate) frame <<= 1;
+        plan = RealFFTPlan(frame);
+        window = makeWindow(frame);
+        frameBuf.resize(frame); work.resize(frame);
+        spec.resize(plan.bins()); average.resize(plan.bins());
+        steady.resize(plan.bins()); steadyNext.resize(plan.bins());
+        reset();
+    }
+
+    void analyze() {
+        for (size_t i = 0; i < frame; i++) work[i] = frameBuf[i] * window[i];
+        plan.forward(work.data(), spec.data());
+        const size_t bins = spec.size();
+        for (size_t k = 0; k < bins; k++) average[k] = 0.5 * average[k] + 0.5 * std::norm(spec[k]);
+
+        // Local peaks well above the mean of the bins 3..12 away on both sides; a peak keeps
+        // its count when it moves by one bin between frames
+        const double peakRatio = std::pow(10.0, PEAK_DB / 10.0);
+        const size_t lo = std::max<size_t>(12, (size_t)(100.0 * frame / rate)); // above 100 Hz
+        std::fill(steadyNext.begin(), steadyNext.end(), 0);
+        for (size_t k = lo; k + 12 < bins; k++) {
+            double p = average[k];
+            if (p <= average[k - 1] || p < average[k + 1]) continue;
+            double around = 0.0;
+            for (size_t d = 3; d <= 12; d++) around += average[k - d] + average[k + d];
+            around /= 20.0;
+            if (p < peakRatio * around || p < 1e-12) continue;
+            steadyNext[k] = std::max({steady[k - 1], steady[k], steady[k + 1]}) + 1;
+        }
+        std::swap(steady, steadyNext);
+
+        // The strongest steady carriers, strongest first
+        int maxN = std::clamp(settings.maxNotches, 0, MAX_NOTCHES);
+        double found[MAX_NOTCHES];
+        double foundPower[MAX_NOTCHES];
+        int nFound = 0;
+        for (size_t k = lo; k + 12 < bins; k++) {
+            if (steady[k] < STEADY_FRAMES) continue;
+            double p = average[k];
+            int at = nFound;
+            while (at > 0 && foundPower[at - 1] < p) at--;
+            if (at >= maxN) continue;
+            for (int j = std::min(nFound, maxN - 1); j > at; j--) { found[j] = found[j - 1]; foundPower[j] = foundPower[j - 1]; }
+            double l = std::log(average[k - 1] + 1e-30), c = std::log(p + 1e-30), r = std::log(average[k + 1] + 1e-30);
+            double denom = l - 2.0 * c + r;
+            double offset = denom < 0.0 ? 0.5 * (l - r) / denom : 0.0;
+            found[at] = (k + offset) * rate / frame;
+            foundPower[at] = p;
+            nFound = std::min(nFound + 1, maxN);
+        }
+        assignNotches(found, nFound, maxN);
+    }
+
+    // Carriers near an active notch retune it (state kept), the others take a free slot
+    void assignNotches(const double* found, int nFound, int maxN) {
+        const double match = 2.0 * rate / frame;
+        bool used[MAX_NOTCHES] = {};
+        for (Slot& s : slots) {
+            if (!s.active) continue;
+            int best = -1;
+            for (int i = 0; i < nFound; i++) {
+                if (!used[i] && std::fabs(found[i] - s.freqHz) < match && (best < 0 || std::fabs(found[i] - s.freqHz) < std::fabs(found[best] - s.freqHz))) best = i;
+            }
+            if (best >= 0) {
+                used[best] = true; s.missing = 0;
+                s.freqHz = found[best];
+                s.filter.retune(design(s.freqHz));
+            } else if (++s.missing >= RELEASE_FRAMES) {
+                s.active = false;
+            }
+        }
+        for (int i = 0; i < nFound; i++) {
+            if (used[i]) continue;
+            for (int j = 0; j < maxN; j++) {
+                if (slots[j].active) continue;
+                slots[j].active = true; slots[j].missing = 0;
+                slots[j].freqHz = found[i];
+                slots[j].filter = design(found[i]);
+                break;
+            }
+        }
+        for (int j = maxN; j < MAX_NOTCHES; j++) slots[j].active = false;
+    }
+
+    Biquad design(double freqHz) const {
+        return Biquad::notch(freqHz / rate, freqHz / std::max(settings.widthHz, 1.0f));
+    }
+};
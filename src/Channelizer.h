@@ -0,0 +1,93 @@
+#pragma once
+
+#include "DSP.h"
+#include "FilterDesign.h"
+#include <vector>
+#include <cmath>
+
+// Polyphase FFT filter bank: splits the IQ stream into `channels` equally spaced sub-channels
+// and outputs all of them at sampleRate / decimation. Channel k is centred at
+// k * sampleRate / channels (channels above channels/2 are the negative frequencies), e.g.
+// 3.2 MS/s with 256 channels gives the 12.5 kHz PMR/trunking grid.
+//
+// decimation == channels is critically sampled; channels / 2 (or less) oversamples, so a
+// signal on a channel edge isn't aliased into its neighbour. Per input sample the cost is
+// tapsPerChannel multiply-adds plus one FFT per `decimation` samples, independent of how
+// many channels are used. The output of a channel is plain IQ at channelRate(), ready for
+// a Demodulator or a WavWriter.
+class Channelizer {
+private:
+    size_t numCh;
+    size_t decim;
+    size_t length;               // prototype taps = numCh * tapsPerChannel
+    std::vector<double> taps;    // prototype low-pass, time reversed
+    std::vector<Complex> history; // newest `length` samples, stored twice so the window is contiguous
+    size_t pos = 0;              // next write index in history
+    size_t phase = 0;            // input samples since the last output frame
+    size_t shift;                // (time index of the frame's newest sample) mod numCh
+    std::vector<Complex> fold;
+    std::vector<Complex> frame;
+    FFTPlan plan;
+
+public:
+    // channels must be a power of two and a multiple of decimation
+    Channelizer(size_t channels, size_t decimation, size_t tapsPerChannel = 16)
+        : numCh(channels), decim(decimation), length(channels * tapsPerChannel),
+          history(2 * channels * tapsPerChannel), shift((decimation - 1) % channels),
+          fold(channels), frame(channels), plan(channels)
+    {
+        std::vector<double> h = designLowpass(length, 0.5 / numCh);
+        taps.assign(h.rbegin(), h.rend());
+    }
+
+    size_t numChannels() const { return numCh; }
+    size_t decimation() const { return decim; }
+    double channelRate(double sampleRate) const { return sampleRate / decim; }
+    double channelSpacing(double sampleRate) const { return sampleRate / numCh; }
+
+    // Center of channel k relative to the stream's center frequency
+    double channelCenter(size_t k, double sampleRate) const {
+        long signedK = k < numCh / 2 ? (long)k : (long)k - (long)numCh;
+        return signedK * channelSpacing(sampleRate);
+    }
+
+    // Channel whose center is closest to offsetHz (relative to the stream's center frequency)
+    size_t channelFor(double offsetHz, double sampleRate) const {
+        long k = std::lround(offsetHz / channelSpacing(sampleRate));
+        return (size_t)((k % (long)numCh + (long)numCh) % (long)numCh);
+    }
+
+    // Upper bound of output frames per channel for `inCount` input samples
+    size_t maxOutput(size_t inCount) const { return inCount / decim + 1; }
+
+    // Splits count input samples. Frames of channel k are written to out + k * stride
+    // (stride >= maxOutput(count)); returns the number of frames written per channel.
+    size_t process(const Complex* in, size_t count, Complex* out, size_t stride) {
+        size_t produced = 0;
+        for (size_t i = 0; i < count; i++) {
+            history[pos] = history[pos + length] = in[i];
+            if (++pos == length) pos = 0;
+            if (++phase < decim) continue;
+            phase = 0;
+
+            // Polyphase part: weight the newest `length` samples and fold them onto numCh bins
+            const Complex* w = &history[pos];
+            std::fill(fold.begin(), fold.end(), Complex(0.0, 0.0));
+            for (size_t base = 0; base < length; base += numCh) {
+                for (size_t q = 0; q < numCh; q++) fold[numCh - 1 - q] += w[base + q] * taps[base + q];
+            }
+
+            // Circular shift removes the per-frame channel rotation when oversampling, the
+            // inverse FFT then mixes every channel down to DC at once
+            for (size_t r = 0; r < numCh; r++) frame[r] = fold[(r + shift) % numCh];
+            plan.inverse(frame.data());
+            shift = (shift + decim) % numCh;
+
+            if (produced < stride) {
+                for (size_t k = 0; k < numCh; k++) out[k * stride + produced] = frame[k];
+                produced++;
+            }
+        }
+        return produced;
+    }
+};
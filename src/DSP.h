@@ -7,27 +7,100 @@
 using Complex = std::complex<double>;
 const double PI = 3.14159265358979323846;
 
-// Fast Fourier Transform (Recursive)
-inline void fft(std::vector<Complex>& a) {
-    size_t n = a.size();
-    if (n <= 1) return;
+// Precomputed in-place radix-2 FFT (size must be a power of two).
+// Twiddles and the bit-reversal table are built once, so transforms don't allocate.
+class FFTPlan {
+private:
+    size_t n;
+    std::vector<Complex> twiddle; // e^(-j2pi k/n), k < n/2
+    std::vector<size_t> bitrev;
+
+    void transform(Complex* a, bool inverse) const {
+        for (size_t i = 0; i < n; i++) if (i < bitrev[i]) std::swap(a[i], a[bitrev[i]]);
+        for (size_t len = 2; len <= n; len <<= 1) {
+            size_t half = len / 2, step = n / len;
+            for (size_t i = 0; i < n; i += len) {
+                for (size_t k = 0; k < half; k++) {
+                    Complex w = inverse ? std::conj(twiddle[k * step]) : twiddle[k * step];
+                    Complex t = w * a[i + k + half];
+                    a[i + k + half] = a[i + k] - t;
+                    a[i + k] += t;
+                }
+            }
+        }
+    }
+
+public:
+    explicit FFTPlan(size_t size = 1) : n(size), twiddle(size / 2), bitrev(size) {
+        for (size_t k = 0; k < n / 2; k++) twiddle[k] = std::polar(1.0, -2.0 * PI * k / n);
+        size_t bits = 0; while (((size_t)1 << bits) < n) bits++;
+        for (size_t i = 0; i < n; i++) {
+            size_t r = 0;
+            for (size_t b = 0; b < bits; b++) if (i & ((size_t)1 << b)) r |= (size_t)1 << (bits - 1 - b);
+            bitrev[i] = r;
+        }
+    }
 
-    std::vector<Complex> even(n / 2);
-    std::vector<Complex> odd(n / 2);
+    size_t size() const { return n; }
+    void forward(Complex* a) const { transform(a, false); }
+    // Unnormalized (no 1/n)
+    void inverse(Complex* a) const { transform(a, true); }
+};
 
-    for (size_t i = 0; i < n / 2; i++) { 
-        even[i] = a[2 * i]; 
-        odd[i] = a[2 * i + 1]; 
+// FFT of real data (size n, a power of two >= 4) through a complex FFT of n/2: the even / odd
+// samples are packed as re / im and separated afterwards. n/2 + 1 bins (DC .. Nyquist).
+class RealFFTPlan {
+private:
+    size_t n;
+    FFTPlan half;
+    std::vector<Complex> twiddle; // e^(-j2pi k/n), k < n/2
+
+public:
+    explicit RealFFTPlan(size_t size = 4) : n(size), half(size / 2), twiddle(size / 2) {
+        for (size_t k = 0; k < n / 2; k++) twiddle[k] = std::polar(1.0, -2.0 * PI * k / n);
     }
 
-    fft(even); 
-    fft(odd);
+    size_t size() const { return n; }
+    size_t bins() const { return n / 2 + 1; }
+
+    // in: n samples, out: n/2 + 1 bins
+    void forward(const double* in, Complex* out) const {
+        const size_t m = n / 2;
+        for (size_t k = 0; k < m; k++) out[k] = Complex(in[2 * k], in[2 * k + 1]);
+        half.forward(out);
+        Complex z0 = out[0];
+        out[0] = Complex(z0.real() + z0.imag(), 0.0);
+        out[m] = Complex(z0.real() - z0.imag(), 0.0);
+        for (size_t k = 1; k <= m / 2; k++) {
+            Complex a = out[k], b = std::conj(out[m - k]);
+            Complex even = 0.5 * (a + b), odd = Complex(0.0, -0.5) * (a - b);
+            Complex even2 = std::conj(even), odd2 = std::conj(odd); // the same for bin m - k
+            out[k] = even + twiddle[k] * odd;
+            out[m - k] = even2 + twiddle[m - k] * odd2;
+        }
+    }
 
-    for (size_t k = 0; k < n / 2; k++) {
-        Complex t = std::polar(1.0, -2.0 * PI * k / n) * odd[k];
-        a[k] = even[k] + t;
-        a[k + n / 2] = even[k] - t;
+    // spec: n/2 + 1 bins (overwritten), out: n samples. Unnormalized (no 1/n), like FFTPlan
+    void inverse(Complex* spec, double* out) const {
+        const size_t m = n / 2;
+        Complex dc = spec[0], nyq = spec[m];
+        spec[0] = Complex(dc.real() + nyq.real(), dc.real() - nyq.real());
+        for (size_t k = 1; k <= m / 2; k++) {
+            Complex a = spec[k], b = std::conj(spec[m - k]);
+            Complex even = a + b, odd = (a - b) * std::conj(twiddle[k]);
+            Complex even2 = std::conj(even), odd2 = std::conj(odd); // bin m - k
+            spec[k] = even + Complex(0.0, 1.0) * odd;
+            spec[m - k] = even2 + Complex(0.0, 1.0) * odd2;
+        }
+        half.inverse(spec);
+        for (size_t k = 0; k < m; k++) { out[2 * k] = spec[k].real(); out[2 * k + 1] = spec[k].imag(); }
     }
+};
+
+// Fast Fourier Transform (one-off; keep an FFTPlan for repeated transforms)
+inline void fft(std::vector<Complex>& a) {
+    if (a.size() <= 1) return;
+    FFTPlan(a.size()).forward(a.data());
 }
 
 // Generate Hanning window
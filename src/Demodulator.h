@@ -1,11 +1,26 @@
 #pragma once
 
 #include "DSP.h"
+#include "FirFilter.h"
+#include "FilterDesign.h"
+#include "Rds.h"
+#include "FmDiscriminator.h"
+#include "Agc.h"
+#include "Squelch.h"
+#include "NoiseBlanker.h"
+#include "NoiseReduction.h"
+#include "AutoNotch.h"
+#ifdef ENABLE_FIXED_POINT
+#include "FixedPoint.h"
+#endif
 #include <vector>
 #include <cmath>
 #include <algorithm>
 
-enum class Mode { AM, NFM, WFM, LSB, USB, OFF };
+enum class Mode { AM, NFM, WFM, LSB, USB, CW, SAM, OFF };
+
+// Synchronous AM: both sidebands, or only one of them (the other one may be interfered)
+enum class SamSideband { DSB, USB, LSB };
 
 class Demodulator {
 public:
@@ -13,157 +28,566 @@ public:
     double sampleRateOut;
     double currentPhase = 0;
     
-    // Audio filter states
+    // Audio filter states (the R ones only for WFM stereo)
     float audioLpfState = 0.0f;
-    float deemphState = 0.0f;
-    float wfmDcState = 0.0f;
+    float amDcState = 0.0f;
+    float deemphState = 0.0f, deemphStateR = 0.0f;
+    float wfmDcState = 0.0f, wfmDcStateR = 0.0f;
     
-    // IQ Filter state (Bandwidth control)
-    Complex iqLpfState = Complex(0.0, 0.0);
+    // IQ channel filter (Bandwidth control), taken from the filter cache whenever bandwidthHz changes
+    static constexpr size_t BLOCK_SIZE = 4096; // IQ is mixed and filtered in blocks of this size
+    static constexpr double CHANNEL_TRANSITION_HZ = 2750.0;
+    static constexpr double CHANNEL_ATTENUATION_DB = 70.0;
+    FirFilter channelFilter;
+    double designedBandwidth = -1.0;
+    std::vector<Complex> block;
+
+    // SSB / CW (Weaver method): the tuner centers the passband on 0 Hz, the channel filter and
+    // then the sharp sideband filter at the audio rate keep [-bw/2, bw/2], and the BFO shifts it
+    // back to audio before the real part is taken. The opposite sideband is in the stopband.
+    static constexpr double SIDEBAND_TRANSITION_HZ = 450.0;
+    static constexpr double SSB_LOW_CUT_HZ = 300.0;
+    static constexpr double CW_PITCH_HZ = 700.0;
+    FirFilter sidebandFilter;
+    double sidebandDesigned = -1.0;
+    Complex bfoOsc = Complex(1.0, 0.0);
 
-    // FM discriminator state
+    // FM discriminator state; WFM runs it over the whole block into `phase` first
     Complex lastSample = Complex(1.0, 0.0); 
+    std::vector<double> phase;
 
-    // Buffers
-    float wfmSum = 0.0f;
-    int wfmCount = 0;
+    // WFM multiplex (MPX): the discriminator output is summed down to >= 125 kHz, where the
+    // 19 kHz pilot PLL, the 38 kHz L-R demodulation and the 15 kHz audio filters run
+    static constexpr double WFM_DEVIATION_HZ = 75000.0;
+    static constexpr float WFM_GAIN = 0.8f;
+    int mpxDecimation = 1;
+    double mpxRate;
+    FirDecimator monoLpf, diffLpf;
+    double pilotPhase = 0.0, pilotFreq = 0.0;  // PLL: sin(pilotPhase) follows the pilot
+    double pilotI = 0.0, pilotQ = 0.0;         // pilot in phase / quadrature (x2 = amplitude)
+    bool stereoDetected = false;
 
-    Demodulator(double srIn, double srOut) : sampleRateIn(srIn), sampleRateOut(srOut) {}
+    // RDS, decoded from the same multiplex (PI / PS / RadioText / clock in rds.info)
+    RdsDecoder rds;
 
-    std::vector<float> process(const std::vector<Complex>& rawIQ, double freqOffset, double bandwidthHz, Mode mode) {
-        std::vector<float> audioOut;
-        
-        size_t estimatedOut = rawIQ.size() * sampleRateOut / sampleRateIn + 10;
-        audioOut.reserve(estimatedOut);
+    // Buffers (count is the decimation phase, shared by the WFM and narrowband paths)
+    double mpxSum = 0.0;
+    Complex sum = Complex(0, 0);
+    int count = 0;
+
+    // Settings, applied to the next process() call
+    double freqOffset = 0.0;
+    double bandwidthHz = 12000.0;
+    Mode mode = Mode::NFM;
+    float volume = 1.0f;
+    bool stereo = true;           // WFM: decode stereo when a pilot is present
+    float deemphasisUs = 50.0f;   // WFM: 50 (Europe) or 75 (Americas)
+    DiscriminatorType discriminator = DiscriminatorType::Polynomial; // NFM / WFM, accuracy vs speed
+    double passbandLowHz = SSB_LOW_CUT_HZ; // SSB: passband is [low, low + bandwidth] from the carrier
+    double cwPitchHz = CW_PITCH_HZ;        // CW: BFO offset, i.e. the tone heard for a carrier
+
+    // Synchronous AM: carrier PLL at the audio rate, the derotated signal is detected coherently
+    SamSideband samSideband = SamSideband::DSB;
+    double samPhase = 0.0, samFreq = 0.0;
+
+    // Output level control, after detection in every mode (settings in agc.settings)
+    Agc agc;
+
+    // Squelch on the channel power (summed over the filtered block), CTCSS / DCS in NFM.
+    // With a tone squelch the sub-audio band is removed from the audio.
+    Squelch squelch;
+    double channelPower = 0.0;
+    bool audioOpen = true; // last block had audio (squelch open, mode not OFF)
+    Biquad toneHpf1, toneHpf2;
+
+    // Impulse blanker on the raw IQ, ahead of the tuner (settings in noiseBlanker.settings)
+    NoiseBlanker noiseBlanker;
+
+    // Spectral noise reduction on the narrowband audio, before the AGC (not WFM)
+    NoiseReduction noiseReduction;
+
+    // Automatic notch for carriers in the AM / SSB audio, ahead of the noise reduction
+    AutoNotch autoNotch;
+
+#ifdef ENABLE_FIXED_POINT
+    // NFM in Q15 (FixedPoint.h): convert, NCO mix, FIR decimation straight to the audio rate
+    // and the integer discriminator. A wider transition than the float channel filter keeps
+    // the tap count down on small CPUs.
+    static constexpr double FIXED_TRANSITION_HZ = 5000.0;
+    static constexpr double FIXED_ATTENUATION_DB = 60.0;
+    NcoQ15 ncoQ15;
+    FirDecimatorQ15 channelQ15I, channelQ15Q;
+    double designedQ15 = -1.0, designedQ15Rate = 0.0; // bandwidth / input rate of the Q15 taps
+    std::vector<int16_t> blockQ15I = std::vector<int16_t>(BLOCK_SIZE), blockQ15Q = std::vector<int16_t>(BLOCK_SIZE);
+    int16_t lastQ15I = 0, lastQ15Q = 0;
+
+    static FilterSpec fixedFilterSpec(double srIn, double bwHz) {
+        return FilterSpec{srIn, bwHz / 2.0, FIXED_TRANSITION_HZ, FIXED_ATTENUATION_DB};
+    }
+#endif
+
+    Demodulator(double srIn, double srOut)
+        : sampleRateIn(srIn), sampleRateOut(srOut),
+          channelFilter(channelFilterSpec(srIn, 0.0).taps()), block(BLOCK_SIZE),
+          sidebandFilter(sidebandFilterSpec(srIn / decimationFactor(), 0.0).taps()), phase(BLOCK_SIZE)
+    {
+        // Largest divisor of the audio decimation that keeps the MPX rate above 125 kHz
+        // (L-R reaches 53 kHz, RDS 60 kHz), so MPX samples line up with audio samples
+        int d = decimationFactor();
+        for (int m = d; m > 1; m--) {
+            if (d % m == 0 && sampleRateIn / m >= 125000.0) { mpxDecimation = m; break; }
+        }
+        mpxRate = sampleRateIn / mpxDecimation;
+
+        // 15 kHz audio low-pass, pilot (19 kHz) > 60 dB down
+        double transition = 4000.0 / mpxRate;
+        std::vector<double> h = designLowpass(kaiserLength(transition, 60.0), 16500.0 / mpxRate, WindowType::Kaiser, kaiserBeta(60.0));
+        monoLpf = FirDecimator(h);
+        diffLpf = FirDecimator(h);
+        rds = RdsDecoder(mpxRate);
+
+        double audioRate = sampleRateIn / decimationFactor();
+        toneHpf1 = Biquad::highpass(300.0 / audioRate, 0.5412);
+        toneHpf2 = Biquad::highpass(300.0 / audioRate, 1.3066);
+    }
+
+    // Same transition band at any input rate (the tap count follows the rate), long filters
+    // run as fast convolution
+    static FilterSpec channelFilterSpec(double srIn, double bwHz) {
+        return FilterSpec{srIn, bwHz / 2.0, CHANNEL_TRANSITION_HZ, CHANNEL_ATTENUATION_DB};
+    }
+
+    static FilterSpec sidebandFilterSpec(double audioRate, double bwHz) {
+        return FilterSpec{audioRate, bwHz / 2.0, SIDEBAND_TRANSITION_HZ, CHANNEL_ATTENUATION_DB};
+    }
+
+    // Center of the received passband relative to the carrier (frequency offset)
+    static double passbandCenter(Mode m, double bwHz, double lowHz = SSB_LOW_CUT_HZ) {
+        if (m == Mode::USB) return lowHz + bwHz / 2.0;
+        if (m == Mode::LSB) return -(lowHz + bwHz / 2.0);
+        return 0.0;
+    }
+
+    void configure(double offsetHz, double bwHz, Mode m, float vol) {
+        // Another station: forget its RDS data (small moves while fine tuning keep it)
+        if (m != mode || std::abs(offsetHz - freqOffset) > 25000.0) rds.reset();
+        if (m != mode) { agc.reset(); squelch.tones.reset(); noiseReduction.reset(); autoNotch.reset(); }
+        freqOffset = offsetHz; bandwidthHz = bwHz; mode = m; volume = vol;
+    }
+
+    void setFmOptions(bool stereoOn, float deemphUs) {
+        stereo = stereoOn; deemphasisUs = deemphUs;
+    }
+
+    void setSsbOptions(double lowHz, double pitchHz) {
+        passbandLowHz = lowHz; cwPitchHz = pitchHz;
+    }
 
+    void setSamSideband(SamSideband sb) {
+        samSideband = sb;
+    }
+
+    void setDiscriminator(DiscriminatorType type) {
+        discriminator = type;
+    }
+
+#ifdef ENABLE_FIXED_POINT
+    // false runs NFM through the float kernel instead, to compare the two
+    void setFixedPointNfm(bool enabled) {
+        fixedPointNfm = enabled;
+    }
+#endif
+
+    void setSquelch(const SquelchSettings& s) {
+        if (!(s == squelch.settings)) { squelch.settings = s; squelch.reset(); }
+    }
+
+    bool squelchOpen() const { return audioOpen; }
+
+    void setAgc(const AgcSettings& s) {
+        agc.settings = s;
+    }
+
+    void setNoiseReduction(const NoiseReductionSettings& s) {
+        if (s.enabled != noiseReduction.settings.enabled) noiseReduction.reset();
+        noiseReduction.settings = s;
+    }
+
+    void setAutoNotch(const AutoNotchSettings& s) {
+        if (s.enabled != autoNotch.settings.enabled) autoNotch.reset();
+        autoNotch.settings = s;
+    }
+
+    void setNoiseBlanker(const NoiseBlankerSettings& s) {
+        if (!(s == noiseBlanker.settings)) { noiseBlanker.settings = s; noiseBlanker.reset(); }
+    }
+
+    // Aligns the decimation phase to a stream position, so demodulators fed from the same
+    // stream emit their audio samples at the same input positions (equal output counts per block)
+    void alignDecimation(uint64_t samplesConsumed) {
+        count = (int)(samplesConsumed % decimationFactor());
+    }
+
+    int decimationFactor() const {
         int decimation = static_cast<int>(sampleRateIn / sampleRateOut);
-        if (decimation < 1) decimation = 1;
-
-        // 1. Calculate IQ Filter Coefficient (Bandwidth Control)
-        // This filters the raw RF signal before demodulation.
-        float iqAlpha = 1.0f;
-        if (sampleRateIn > 0) {
-            iqAlpha = 2.0f * (float)PI * (bandwidthHz / 2.0f) / (float)sampleRateIn;
-            if (iqAlpha > 1.0f) iqAlpha = 1.0f;
+        return decimation < 1 ? 1 : decimation;
+    }
+
+    // Upper bound of output samples for `inCount` input samples (decimation state may carry over)
+    size_t maxOutput(size_t inCount) const {
+        return inCount / decimationFactor() + 1;
+    }
+
+    // Streaming demodulation: reads `inCount` IQ samples, writes at most `outCapacity` audio samples
+    // (AGC and volume applied, clamped) and returns how many were written. Allocation-free, except
+    // for designing the channel filter once for a bandwidth that isn't cached yet.
+    // The mode is resolved once per block; each mode runs its own compiled kernel.
+    // With rightOut, audioOut gets the left channel and rightOut the right one (WFM stereo;
+    // other modes and mono broadcasts write the same samples to both).
+    size_t process(const Complex* rawIQ, size_t inCount, float* audioOut, size_t outCapacity, float* rightOut = nullptr) {
+        if (bandwidthHz != designedBandwidth) updateChannelFilter();
+        bool sideband = mode == Mode::LSB || mode == Mode::USB || mode == Mode::CW || mode == Mode::SAM;
+        if (sideband && sidebandBandwidth() != sidebandDesigned) updateSidebandFilter();
+        BlockCoeffs k = makeCoeffs();
+        size_t outCount = 0;
+        channelPower = 0.0;
+
+        switch (mode) {
+            case Mode::AM:  outCount = runKernel<Mode::AM>(rawIQ, inCount, audioOut, nullptr, outCapacity, k); break;
+            case Mode::NFM:
+#ifdef ENABLE_FIXED_POINT
+                if (fixedPointNfm) { outCount = runFixedNfm(rawIQ, inCount, audioOut, outCapacity, k); break; }
+#endif
+                outCount = runKernel<Mode::NFM>(rawIQ, inCount, audioOut, nullptr, outCapacity, k); break;
+            case Mode::WFM: outCount = runKernel<Mode::WFM>(rawIQ, inCount, audioOut, rightOut, outCapacity, k); break;
+            case Mode::LSB: outCount = runKernel<Mode::LSB>(rawIQ, inCount, audioOut, nullptr, outCapacity, k); break;
+            case Mode::USB: outCount = runKernel<Mode::USB>(rawIQ, inCount, audioOut, nullptr, outCapacity, k); break;
+            case Mode::CW:  outCount = runKernel<Mode::CW>(rawIQ, inCount, audioOut, nullptr, outCapacity, k); break;
+            case Mode::SAM: outCount = runKernel<Mode::SAM>(rawIQ, inCount, audioOut, nullptr, outCapacity, k); break;
+            case Mode::OFF: outCount = runSilence(inCount, audioOut, outCapacity, k); break;
+        }
+        float* right = (rightOut && mode == Mode::WFM) ? rightOut : nullptr;
+        double audioRate = sampleRateIn / k.decimation;
+        bool open = mode != Mode::OFF
+            && squelch.update(channelPower / std::max<size_t>(inCount, 1), audioOut, outCount, audioRate, mode == Mode::NFM);
+        audioOpen = open;
+        if (open) {
+            if (squelch.toneRequired()) {
+                for (size_t i = 0; i < outCount; i++) audioOut[i] = toneHpf2.process(toneHpf1.process(audioOut[i]));
+            }
+            bool voiceMode = mode == Mode::AM || mode == Mode::SAM || mode == Mode::LSB || mode == Mode::USB;
+            if (autoNotch.settings.enabled && voiceMode) autoNotch.process(audioOut, outCount, audioRate);
+            if (noiseReduction.settings.enabled && mode != Mode::WFM) noiseReduction.process(audioOut, outCount, audioRate);
+            agc.process(audioOut, right, outCount, audioRate);
+            applyVolume(audioOut, outCount);
+            if (right) applyVolume(right, outCount);
+        } else {
+            std::fill(audioOut, audioOut + outCount, 0.0f);
+            if (right) std::fill(right, right + outCount, 0.0f);
+        }
+        if (rightOut && mode != Mode::WFM) std::copy(audioOut, audioOut + outCount, rightOut);
+        
+        // Update phase for next block
+        currentPhase += k.phaseStep * inCount;
+        currentPhase = std::fmod(currentPhase, 2.0 * PI);
+        bfoOsc /= std::abs(bfoOsc);
+
+        return outCount;
+    }
+
+private:
+#ifdef ENABLE_FIXED_POINT
+    bool fixedPointNfm = true;
+#endif
+
+    // Per-block constants shared by every mode kernel
+    struct BlockCoeffs {
+        double phaseStep;   // tuner phase increment per input sample
+        Complex bfoStep;    // SSB / CW: passband back to audio, per output sample (SAM: sideband center)
+        double samKp, samKi, samMaxFreq; // SAM carrier PLL
+        float audioAlpha;   // audio post-filter
+        float deemphAlpha;  // WFM de-emphasis (audio rate)
+        int decimation;
+        // WFM multiplex
+        double mpxScale;    // summed discriminator output -> 1.0 = full deviation
+        double diffGain;    // undoes the MPX boxcar's droop at 38 kHz
+        double pilotStep, pilotKp, pilotKi, pilotMaxDev, pilotAlpha;
+    };
+
+    BlockCoeffs makeCoeffs() const {
+        BlockCoeffs k;
+        double center = passbandCenter(mode, bandwidthHz, passbandLowHz);
+        k.phaseStep = -2.0 * PI * ((freqOffset + center) / sampleRateIn);
+
+        k.decimation = decimationFactor();
+        double bfoHz = center + (mode == Mode::CW ? cwPitchHz : 0.0);
+        if (mode == Mode::SAM && samSideband != SamSideband::DSB) {
+            bfoHz = (samSideband == SamSideband::USB ? 1.0 : -1.0) * bandwidthHz / 4.0;
         }
+        k.bfoStep = std::polar(1.0, 2.0 * PI * bfoHz * k.decimation / sampleRateIn);
 
-        // 2. Calculate Audio Filter Coefficient
-        float audioAlpha = 0.0f;
+        // SAM PLL: 50 Hz loop bandwidth follows fading and drift, pulls in +-500 Hz of mistuning
+        double audioRate = sampleRateIn / k.decimation;
+        double samWn = 2.0 * PI * 50.0 / audioRate;
+        k.samKp = 2.0 * 0.707 * samWn;
+        k.samKi = samWn * samWn;
+        k.samMaxFreq = 2.0 * PI * 500.0 / audioRate;
+
+        // 1. Calculate Audio Filter Coefficient
+        k.audioAlpha = 0.0f;
         if (sampleRateOut > 0) {
             // Fixed ~16kHz lowpass for audio
-            audioAlpha = 2.0f * (float)PI * 16000.0f / (float)sampleRateOut;
-            if (audioAlpha > 1.0f) audioAlpha = 1.0f;
+            k.audioAlpha = 2.0f * (float)PI * 16000.0f / (float)sampleRateOut;
+            if (k.audioAlpha > 1.0f) k.audioAlpha = 1.0f;
         }
         
-        // 3. De-emphasis Coefficient (for WFM)
-        float deemphAlpha = 0.0f;
-        if (sampleRateIn > 0) {
-            deemphAlpha = 2.0f * (float)PI * 2100.0f / (float)sampleRateIn;
-            if (deemphAlpha > 1.0f) deemphAlpha = 1.0f;
+        // 2. De-emphasis Coefficient (for WFM), one pole with time constant deemphasisUs
+        k.deemphAlpha = (float)(1.0 - std::exp(-1.0 / (deemphasisUs * 1e-6 * audioRate)));
+
+        // 3. Pilot PLL (30 Hz loop bandwidth, critically damped; the phase error is normalized
+        // by the pilot amplitude, so the detector gain is 0.5 at any pilot level)
+        k.mpxScale = sampleRateIn / (2.0 * PI * WFM_DEVIATION_HZ) / mpxDecimation;
+        double x = PI * 38000.0 / sampleRateIn;
+        k.diffGain = (mpxDecimation > 1) ? mpxDecimation * std::sin(x) / std::sin(x * mpxDecimation) : 1.0;
+        double wn = 2.0 * PI * 30.0 / mpxRate;
+        k.pilotStep = 2.0 * PI * 19000.0 / mpxRate;
+        k.pilotKp = 2.0 * 0.707 * wn / 0.5;
+        k.pilotKi = wn * wn / 0.5;
+        k.pilotMaxDev = 2.0 * PI * 100.0 / mpxRate;
+        k.pilotAlpha = 1.0 / (0.02 * mpxRate);
+        return k;
+    }
+
+    // --- Stages shared by the kernels ---
+
+    // Channel filter taps for the current bandwidth; the filter crossfades to them, so no click
+    void updateChannelFilter() {
+        FilterCache::Taps taps = FilterCache::lowpass(channelFilterSpec(sampleRateIn, bandwidthHz));
+        channelFilter.setTaps(taps->data());
+        designedBandwidth = bandwidthHz;
+    }
+
+    void updateSidebandFilter() {
+        FilterCache::Taps taps = FilterCache::lowpass(sidebandFilterSpec(sampleRateIn / decimationFactor(), sidebandBandwidth()));
+        sidebandFilter.setTaps(taps->data());
+        sidebandDesigned = sidebandBandwidth();
+    }
+
+    // SSB / CW keep the whole bandwidth, SAM one sideband of it
+    double sidebandBandwidth() const {
+        return mode == Mode::SAM ? bandwidthHz / 2.0 : bandwidthHz;
+    }
+
+    // A+B. Impulse blanker, frequency shift (tuner) and channel filter: pass only the signal
+    // within the selected bandwidth. Fills block[0, n).
+    void mixAndFilter(const Complex* raw, size_t n, Complex& osc, Complex oscStep) {
+        if (noiseBlanker.settings.enabled) {
+            noiseBlanker.process(raw, block.data(), n, sampleRateIn);
+            raw = block.data();
         }
+        for (size_t i = 0; i < n; i++) {
+            block[i] = raw[i] * osc;
+            osc *= oscStep;
+        }
+        channelFilter.process(block.data(), block.data(), n);
+    }
 
-        Complex osc;
-        Complex sample;
-        Complex sum(0, 0); 
-        int count = 0;
-
-        for (size_t i = 0; i < rawIQ.size(); i++) {
-            // A. Frequency Shift (Tuner)
-            double angle = -2.0 * PI * (freqOffset / sampleRateIn) * i;
-            double globalAngle = currentPhase + angle; 
-            osc = std::polar(1.0, globalAngle);
-            sample = rawIQ[i] * osc;
-
-            // B. IQ Low-Pass Filter
-            // Pass only the signal within the selected bandwidth.
-            iqLpfState = iqLpfState + (Complex(iqAlpha, 0) * (sample - iqLpfState));
-            Complex processedSample = iqLpfState; 
-
-            // --- WFM PATH (High-rate processing) ---
-            if (mode == Mode::WFM) {
-                Complex phaseDiff = processedSample * std::conj(lastSample);
-                lastSample = processedSample; 
-                
-                float rawDemod = std::arg(phaseDiff);
-
-                // De-emphasis
-                deemphState += deemphAlpha * (rawDemod - deemphState);
-                float audioSample = deemphState;
-
-                // Audio Decimation
-                wfmSum += audioSample;
-                wfmCount++;
-
-                if (wfmCount >= decimation) {
-                    float out = (wfmSum / (float)wfmCount); 
-                    out *= 4.0f; // Gain
-
-                    // DC Blocker
-                    wfmDcState = 0.995f * wfmDcState + 0.005f * out;
-                    out -= wfmDcState;
-
-                    // Hard Limiter
-                    if (out > 0.8f) out = 0.8f;
-                    if (out < -0.8f) out = -0.8f;
-
-                    audioOut.push_back(out);
-                    wfmSum = 0.0f;
-                    wfmCount = 0;
-                }
+    // Narrowband detector, one output per decimated sample
+    template <Mode M>
+    float detect(Complex filtered, const BlockCoeffs& k) {
+        if constexpr (M == Mode::AM) {
+            float mag = std::abs(filtered);
+            amDcState = 0.995f * amDcState + 0.005f * mag;
+            return mag - amDcState;
+        } else if constexpr (M == Mode::NFM) {
+            // Note: reusing lastSample state variable for NFM discriminator
+            float delta = (float)phaseStep(discriminator, filtered, lastSample);
+            lastSample = filtered; 
+            return delta * 0.5f; 
+        } else if constexpr (M == Mode::SAM) {
+            // Derotate by the PLL's carrier estimate: the carrier ends up on the real axis
+            Complex y = filtered * std::polar(1.0, -samPhase);
+            double err = fastAtan2(y.imag(), y.real());
+            samFreq = std::clamp(samFreq + k.samKi * err, -k.samMaxFreq, k.samMaxFreq);
+            samPhase = std::fmod(samPhase + samFreq + k.samKp * err, 2.0 * PI);
+
+            float audio = (float)y.real();
+            if (samSideband != SamSideband::DSB) {
+                // Complex band-pass over one sideband: shift its center to 0, low-pass, shift back
+                Complex s = y * std::conj(bfoOsc);
+                sidebandFilter.process(&s, &s, 1);
+                audio = (float)(s * bfoOsc).real() * 2.0f;
+                bfoOsc *= k.bfoStep;
+            }
+            amDcState = 0.995f * amDcState + 0.005f * audio;
+            return audio - amDcState;
+        } else {
+            static_assert(M == Mode::LSB || M == Mode::USB || M == Mode::CW, "no narrowband detector for this mode");
+            sidebandFilter.process(&filtered, &filtered, 1);
+            Complex audio = filtered * bfoOsc;
+            bfoOsc *= k.bfoStep;
+            return (float)audio.real() * 2.0f;
+        }
+    }
+
+    // One MPX sample: pilot PLL, then feed the mono (L+R) and L-R audio filters and RDS
+    void decodeMpx(double mpx, bool wantStereo, const BlockCoeffs& k) {
+        double s = std::sin(pilotPhase), c = std::cos(pilotPhase);
+        pilotI += k.pilotAlpha * (mpx * s - pilotI);
+        pilotQ += k.pilotAlpha * (mpx * c - pilotQ);
+        double amplitude = 2.0 * std::sqrt(pilotI * pilotI + pilotQ * pilotQ);
+
+        double err = mpx * c / std::max(amplitude, 0.01);
+        pilotFreq = std::clamp(pilotFreq + k.pilotKi * err, -k.pilotMaxDev, k.pilotMaxDev);
+        pilotPhase += k.pilotStep + pilotFreq + k.pilotKp * err;
+        if (pilotPhase > 2.0 * PI) pilotPhase -= 2.0 * PI;
+
+        // Locked pilot (normally ~9% of the deviation) with hysteresis
+        double locked = 2.0 * pilotI;
+        if (locked > 0.04) stereoDetected = true;
+        else if (locked < 0.025) stereoDetected = false;
+
+        monoLpf.push(mpx);
+        // L-R is DSB-SC on sin(2 * pilot); x2 restores its level
+        if (wantStereo) diffLpf.push(stereoDetected ? 4.0 * k.diffGain * mpx * s * c : 0.0);
+        rds.push(mpx);
+    }
+
+    // WFM audio stage for one channel: de-emphasis, gain, DC block
+    float wfmAudio(float x, float& deemph, float& dc, const BlockCoeffs& k) {
+        deemph += k.deemphAlpha * (x - deemph);
+        float out = deemph * WFM_GAIN;
+
+        // DC Blocker
+        dc = 0.995f * dc + 0.005f * out;
+        out -= dc;
+        return out;
+    }
+
+    // Audio post-filter (narrowband modes)
+    float postFilter(float rawAudio, float audioAlpha) {
+        if (std::isnan(audioLpfState)) audioLpfState = 0.0f;
+        audioLpfState += audioAlpha * (rawAudio - audioLpfState);
+        return audioLpfState;
+    }
+
+    // Final stage of every mode: volume, then clamp to the output range
+    void applyVolume(float* audio, size_t n) const {
+        for (size_t i = 0; i < n; i++) audio[i] = std::clamp(audio[i] * volume, -1.0f, 1.0f);
+    }
+
+    // --- OFF: no processing, just keep the output rate ---
+    size_t runSilence(size_t inCount, float* audioOut, size_t outCapacity, const BlockCoeffs& k) {
+        count += (int)inCount;
+        size_t n = std::min((size_t)(count / k.decimation), outCapacity);
+        std::fill(audioOut, audioOut + n, 0.0f);
+        count %= k.decimation;
+        sum = Complex(0, 0);
+        return n;
+    }
+
+#ifdef ENABLE_FIXED_POINT
+    // --- NFM, fixed point ---
+    size_t runFixedNfm(const Complex* rawIQ, size_t inCount, float* audioOut, size_t outCapacity, const BlockCoeffs& k) {
+        if (bandwidthHz != designedQ15 || sampleRateIn != designedQ15Rate) {
+            // The length only depends on the rate, so a new bandwidth keeps the delay lines
+            FilterCache::Taps taps = FilterCache::lowpass(fixedFilterSpec(sampleRateIn, bandwidthHz));
+            channelQ15I.setTaps(*taps);
+            channelQ15Q.setTaps(*taps);
+            designedQ15 = bandwidthHz; designedQ15Rate = sampleRateIn;
+        }
+        ncoQ15.setFrequency(k.phaseStep / (2.0 * PI));
+
+        size_t outCount = 0;
+        for (size_t start = 0; start < inCount; start += BLOCK_SIZE) {
+            size_t n = std::min(BLOCK_SIZE, inCount - start);
+            int16_t* re = blockQ15I.data();
+            int16_t* im = blockQ15Q.data();
+            const Complex* in = rawIQ + start;
+            if (noiseBlanker.settings.enabled) {
+                noiseBlanker.process(in, block.data(), n, sampleRateIn);
+                in = block.data();
+            }
+            convertToQ15(in, re, im, n);
+            ncoQ15.mix(re, im, n);
+
+            for (size_t i = 0; i < n; i++) {
+                channelQ15I.push(re[i]);
+                channelQ15Q.push(im[i]);
+                if (++count < k.decimation) continue;
+                count = 0;
+
+                int16_t fi = channelQ15I.output(), fq = channelQ15Q.output();
+                channelPower += ((double)fi * fi + (double)fq * fq) * (k.decimation / 1073741824.0);
+                int16_t step = phaseStepQ15(fi, fq, lastQ15I, lastQ15Q);
+                lastQ15I = fi; lastQ15Q = fq;
+
+                // Same scale as the float detector (radians / 2)
+                float out = postFilter(step * (float)(PI / 32768.0) * 0.5f, k.audioAlpha);
+                if (outCount < outCapacity) audioOut[outCount++] = out;
             }
-            // --- NARROWBAND PATH (AM, NFM, SSB) ---
-            else {
-                sum += processedSample;
-                count++;
-
-                if (count >= decimation) {
-                    if (mode == Mode::OFF) {
-                        audioOut.push_back(0.0f); 
-                        sum = Complex(0, 0); 
-                        count = 0; 
-                        continue;
+        }
+        return outCount;
+    }
+#endif
+
+    template <Mode M>
+    size_t runKernel(const Complex* rawIQ, size_t inCount, float* audioOut, float* rightOut, size_t outCapacity, const BlockCoeffs& k) {
+        size_t outCount = 0;
+
+        // Tuner oscillator as a rotating phasor, restarted from currentPhase every block
+        Complex osc = std::polar(1.0, currentPhase);
+        const Complex oscStep = std::polar(1.0, k.phaseStep);
+        const bool wantStereo = rightOut && stereo;
+
+        for (size_t start = 0; start < inCount; start += BLOCK_SIZE) {
+            size_t n = std::min(BLOCK_SIZE, inCount - start);
+            mixAndFilter(rawIQ + start, n, osc, oscStep);
+            for (size_t i = 0; i < n; i++) channelPower += std::norm(block[i]);
+            if constexpr (M == Mode::WFM) discriminate(discriminator, block.data(), n, lastSample, phase.data());
+
+            for (size_t i = 0; i < n; i++) {
+                Complex processedSample = block[i];
+
+                // --- WFM PATH (High-rate processing) ---
+                if constexpr (M == Mode::WFM) {
+                    // FM discriminator output, summed down to the multiplex rate
+                    mpxSum += phase[i];
+                    count++;
+
+                    if (count % mpxDecimation == 0) {
+                        decodeMpx(mpxSum * k.mpxScale, wantStereo, k);
+                        mpxSum = 0.0;
                     }
 
-                    Complex filtered = sum / (double)count;
-                    sum = Complex(0, 0);
-                    count = 0;
-
-                    float rawAudio = 0.0f;
-
-                    if (mode == Mode::AM) {
-                        static float dcBlock = 0.0f;
-                        float mag = std::abs(filtered);
-                        dcBlock = 0.995f * dcBlock + 0.005f * mag;
-                        rawAudio = mag - dcBlock;
-                    } 
-                    else if (mode == Mode::NFM) {
-                        // Note: reusing lastSample state variable for NFM discriminator
-                        Complex phaseDiff = filtered * std::conj(lastSample);
-                        float delta = std::arg(phaseDiff);
-                        rawAudio = delta * 0.5f; 
-                        lastSample = filtered; 
+                    // Audio Decimation (an MPX sample was just produced, the audio filters are current)
+                    if (count >= k.decimation) {
+                        count = 0;
+                        float mono = (float)monoLpf.output();
+                        float diff = (wantStereo && stereoDetected) ? (float)diffLpf.output() : 0.0f;
+                        if (outCount < outCapacity) {
+                            audioOut[outCount] = wfmAudio(mono + diff, deemphState, wfmDcState, k);
+                            if (rightOut) rightOut[outCount] = wfmAudio(mono - diff, deemphStateR, wfmDcStateR, k);
+                            outCount++;
+                        }
                     }
-                    else if (mode == Mode::LSB || mode == Mode::USB) {
-                        rawAudio = filtered.real() * 2.0f;
+                }
+                // --- NARROWBAND PATH (AM, NFM, SSB) ---
+                else {
+                    sum += processedSample;
+                    count++;
+
+                    if (count >= k.decimation) {
+                        Complex filtered = sum / (double)count;
+                        sum = Complex(0, 0);
+                        count = 0;
+
+                        float out = postFilter(detect<M>(filtered, k), k.audioAlpha);
+                        if (outCount < outCapacity) audioOut[outCount++] = out;
                     }
-                    
-                    // Audio Post-Filter
-                    if (std::isnan(audioLpfState)) audioLpfState = 0.0f;
-                    audioLpfState += audioAlpha * (rawAudio - audioLpfState);
-                    
-                    // Clamp
-                    if (audioLpfState > 1.0f) audioLpfState = 1.0f;
-                    if (audioLpfState < -1.0f) audioLpfState = -1.0f;
-
-                    audioOut.push_back(audioLpfState);
                 }
             }
         }
-        
-        // Update phase for next block
-        currentPhase += -2.0 * PI * (freqOffset / sampleRateIn) * rawIQ.size();
-        currentPhase = std::fmod(currentPhase, 2.0 * PI);
-
-        return audioOut;
+        return outCount;
     }
 };
\ No newline at end of file
@@ -0,0 +1,357 @@
+#pragma once
+
+#include "DSP.h"
+#include <vector>
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <cmath>
+#include <algorithm>
+
+// FIR filter design. Frequencies are relative to the sample rate (0..0.5) unless the name
+// says Hz. Low-pass style designs are normalized to unity gain at DC.
+
+enum class WindowType { Hann, Blackman, BlackmanHarris, Kaiser };
+
+// --- WINDOWS ---
+
+// Modified Bessel function of the first kind, order 0 (series)
+inline double besselI0(double x) {
+    double sum = 1.0, term = 1.0, q = x * x / 4.0;
+    for (int k = 1; k < 50 && term > 1e-12 * sum; k++) {
+        term *= q / ((double)k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+// Kaiser beta for a stop-band attenuation in dB
+inline double kaiserBeta(double attenDb) {
+    if (attenDb > 50.0) return 0.1102 * (attenDb - 8.7);
+    if (attenDb > 21.0) return 0.5842 * std::pow(attenDb - 21.0, 0.4) + 0.07886 * (attenDb - 21.0);
+    return 0.0;
+}
+
+// Taps (odd, for a linear-phase type I filter) a Kaiser design needs for a transition width
+inline size_t kaiserLength(double transition, double attenDb) {
+    double n = (attenDb - 8.0) / (2.285 * 2.0 * PI * transition) + 1.0;
+    size_t taps = (size_t)std::ceil(std::max(n, 3.0));
+    return taps | 1;
+}
+
+inline double windowValue(WindowType type, size_t i, size_t n, double beta = 0.0) {
+    if (n < 2) return 1.0;
+    double x = (double)i / (double)(n - 1);
+    switch (type) {
+        case WindowType::Hann:
+            return 0.5 - 0.5 * std::cos(2.0 * PI * x);
+        case WindowType::Blackman:
+            return 0.42 - 0.5 * std::cos(2.0 * PI * x) + 0.08 * std::cos(4.0 * PI * x);
+        case WindowType::BlackmanHarris:
+            return 0.35875 - 0.48829 * std::cos(2.0 * PI * x) + 0.14128 * std::cos(4.0 * PI * x) - 0.01168 * std::cos(6.0 * PI * x);
+        case WindowType::Kaiser: {
+            double r = 2.0 * x - 1.0;
+            return besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(beta);
+        }
+    }
+    return 1.0;
+}
+
+// --- WINDOWED-SINC DESIGNS ---
+
+// Low-pass with its -6 dB point at cutoff. Writes into h, so redesigning doesn't allocate.
+inline void designLowpass(double* h, size_t taps, double cutoff, WindowType window = WindowType::Blackman, double beta = 0.0) {
+    double mid = (taps - 1) / 2.0, sum = 0.0;
+    for (size_t i = 0; i < taps; i++) {
+        double x = i - mid;
+        double sinc = (x == 0.0) ? 2.0 * cutoff : std::sin(2.0 * PI * cutoff * x) / (PI * x);
+        h[i] = sinc * windowValue(window, i, taps, beta);
+        sum += h[i];
+    }
+    for (size_t i = 0; i < taps; i++) h[i] /= sum;
+}
+
+inline std::vector<double> designLowpass(size_t taps, double cutoff, WindowType window = WindowType::Blackman, double beta = 0.0) {
+    std::vector<double> h(taps);
+    designLowpass(h.data(), taps, cutoff, window, beta);
+    return h;
+}
+
+// Real band-pass between low and high (-6 dB points), unity gain at the band center
+inline std::vector<double> designBandpass(size_t taps, double low, double high, WindowType window = WindowType::Blackman, double beta = 0.0) {
+    std::vector<double> h = designLowpass(taps, (high - low) / 2.0, window, beta);
+    double center = (low + high) / 2.0, mid = (taps - 1) / 2.0;
+    for (size_t i = 0; i < taps; i++) h[i] *= 2.0 * std::cos(2.0 * PI * center * (i - mid));
+    return h;
+}
+
+// Half-band low-pass (cutoff 0.25): every second tap is exactly zero, so a 2x decimator
+// built on it needs only half the multiplies. taps is rounded up to 4k+3.
+inline std::vector<double> designHalfband(size_t taps, WindowType window = WindowType::Kaiser, double beta = kaiserBeta(80.0)) {
+    while (taps % 4 != 3) taps++;
+    std::vector<double> h = designLowpass(taps, 0.25, window, beta);
+    size_t mid = (taps - 1) / 2;
+    double oddSum = 0.0;
+    for (size_t i = 0; i < taps; i++) {
+        size_t d = i > mid ? i - mid : mid - i;
+        if (d != 0 && d % 2 == 0) h[i] = 0.0;
+        else if (d % 2 == 1) oddSum += h[i];
+    }
+    for (size_t i = 0; i < taps; i++) if (i != mid) h[i] *= 0.5 / oddSum;
+    h[mid] = 0.5;
+    return h;
+}
+
+// Hilbert transformer (90 degree phase shift), odd taps, delay (taps - 1) / 2
+inline std::vector<double> designHilbert(size_t taps, WindowType window = WindowType::BlackmanHarris, double beta = 0.0) {
+    taps |= 1;
+    std::vector<double> h(taps, 0.0);
+    long mid = (long)(taps - 1) / 2;
+    for (size_t i = 0; i < taps; i++) {
+        long d = (long)i - mid;
+        if (d % 2 != 0) h[i] = 2.0 / (PI * d) * windowValue(window, i, taps, beta);
+    }
+    return h;
+}
+
+// Root-raised-cosine pulse shaping / matched filter, spanning spanSymbols symbols.
+// Normalized to unit energy.
+inline std::vector<double> designRootRaisedCosine(double samplesPerSymbol, double rolloff, int spanSymbols) {
+    size_t taps = (size_t)std::lround(samplesPerSymbol * spanSymbols) | 1;
+    std::vector<double> h(taps);
+    double mid = (taps - 1) / 2.0, b = rolloff, energy = 0.0;
+    for (size_t i = 0; i < taps; i++) {
+        double t = (i - mid) / samplesPerSymbol; // in symbols
+        double v;
+        if (std::abs(t) < 1e-9) {
+            v = 1.0 + b * (4.0 / PI - 1.0);
+        } else if (b > 0.0 && std::abs(std::abs(t) - 1.0 / (4.0 * b)) < 1e-9) {
+            v = b / std::sqrt(2.0) * ((1.0 + 2.0 / PI) * std::sin(PI / (4.0 * b)) + (1.0 - 2.0 / PI) * std::cos(PI / (4.0 * b)));
+        } else {
+            v = (std::sin(PI * t * (1.0 - b)) + 4.0 * b * t * std::cos(PI * t * (1.0 + b)))
+                / (PI * t * (1.0 - (4.0 * b * t) * (4.0 * b * t)));
+        }
+        h[i] = v;
+        energy += v * v;
+    }
+    for (double& v : h) v /= std::sqrt(energy);
+    return h;
+}
+
+// --- EQUIRIPPLE (Parks-McClellan) ---
+
+// Linear-phase low-pass with equal ripple in both bands (Remez exchange). passEdge < stopEdge;
+// stopWeight > 1 trades pass-band ripple for stop-band attenuation. Meant for short and
+// medium filters (up to a few hundred taps); longer ones use the Kaiser designs.
+inline std::vector<double> designEquiripple(size_t taps, double passEdge, double stopEdge, double stopWeight = 1.0) {
+    taps |= 1;
+    const size_t L = (taps - 1) / 2; // cos(k w) basis, k = 0..L
+    const size_t r = L + 2;          // extremal frequencies
+
+    // Dense grid over both bands
+    std::vector<double> grid, desired, weight;
+    size_t density = 16 * r;
+    double total = passEdge + (0.5 - stopEdge);
+    size_t nPass = std::max<size_t>(2, (size_t)(density * passEdge / total));
+    size_t nStop = std::max<size_t>(2, density - nPass);
+    for (size_t i = 0; i < nPass; i++) { grid.push_back(passEdge * i / (nPass - 1)); desired.push_back(1.0); weight.push_back(1.0); }
+    for (size_t i = 0; i < nStop; i++) { grid.push_back(stopEdge + (0.5 - stopEdge) * i / (nStop - 1)); desired.push_back(0.0); weight.push_back(stopWeight); }
+    const size_t G = grid.size();
+    std::vector<double> xg(G);
+    for (size_t g = 0; g < G; g++) xg[g] = std::cos(2.0 * PI * grid[g]);
+
+    std::vector<size_t> ext(r);
+    for (size_t i = 0; i < r; i++) ext[i] = i * (G - 1) / (r - 1);
+
+    std::vector<double> x(r), bary(r), c(r), err(G);
+    double delta = 0.0;
+
+    // Amplitude response at cos(w) = xv, interpolated through the first r - 1 extremals
+    auto amplitude = [&](double xv) {
+        double num = 0.0, den = 0.0;
+        for (size_t i = 0; i + 1 < r; i++) {
+            double d = xv - x[i];
+            if (std::abs(d) < 1e-14) return c[i];
+            double t = bary[i] / d;
+            num += t * c[i]; den += t;
+        }
+        return num / den;
+    };
+
+    for (int iter = 0; iter < 40; iter++) {
+        for (size_t i = 0; i < r; i++) x[i] = xg[ext[i]];
+
+        // Levelled error delta over all r points
+        double num = 0.0, den = 0.0;
+        for (size_t i = 0; i < r; i++) {
+            double b = 1.0;
+            for (size_t j = 0; j < r; j++) if (j != i) b *= 2.0 * (x[i] - x[j]);
+            b = 1.0 / b;
+            num += b * desired[ext[i]];
+            den += b * ((i % 2) ? -1.0 : 1.0) / weight[ext[i]];
+        }
+        delta = num / den;
+        for (size_t i = 0; i < r; i++) c[i] = desired[ext[i]] - ((i % 2) ? -1.0 : 1.0) * delta / weight[ext[i]];
+
+        // Interpolation weights over the first r - 1 points
+        for (size_t i = 0; i + 1 < r; i++) {
+            double b = 1.0;
+            for (size_t j = 0; j + 1 < r; j++) if (j != i) b *= 2.0 * (x[i] - x[j]);
+            bary[i] = 1.0 / b;
+        }
+
+        for (size_t g = 0; g < G; g++) err[g] = weight[g] * (desired[g] - amplitude(xg[g]));
+
+        // New extremals: local maxima of |err| (band edges included), kept alternating in sign
+        std::vector<size_t> cand;
+        for (size_t g = 0; g < G; g++) {
+            bool edge = (g == 0 || g == G - 1 || g == nPass - 1 || g == nPass);
+            double e = std::abs(err[g]);
+            bool peak = (g == 0 || e >= std::abs(err[g - 1])) && (g == G - 1 || e >= std::abs(err[g + 1]));
+            if (peak || (edge && e > 0.0)) cand.push_back(g);
+        }
+        std::vector<size_t> alt;
+        for (size_t g : cand) {
+            if (!alt.empty() && (err[g] > 0) == (err[alt.back()] > 0)) {
+                if (std::abs(err[g]) > std::abs(err[alt.back()])) alt.back() = g;
+            } else {
+                alt.push_back(g);
+            }
+        }
+        while (alt.size() > r) {
+            // Drop the smaller end
+            if (std::abs(err[alt.front()]) < std::abs(err[alt.back()])) alt.erase(alt.begin());
+            else alt.pop_back();
+        }
+        if (alt.size() < r) break;
+
+        double maxErr = 0.0;
+        for (size_t g : alt) maxErr = std::max(maxErr, std::abs(err[g]));
+        bool same = std::equal(alt.begin(), alt.end(), ext.begin());
+        ext = alt;
+        if (same || maxErr - std::abs(delta) < 1e-9 * std::max(1.0, maxErr)) break;
+    }
+    for (size_t i = 0; i < r; i++) x[i] = xg[ext[i]];
+
+    // Frequency sampling of the final amplitude response -> symmetric impulse response
+    std::vector<double> A(L + 1);
+    for (size_t m = 0; m <= L; m++) A[m] = amplitude(std::cos(2.0 * PI * m / (double)taps));
+    std::vector<double> h(taps);
+    for (size_t n = 0; n < taps; n++) {
+        double v = A[0];
+        for (size_t m = 1; m <= L; m++) v += 2.0 * A[m] * std::cos(2.0 * PI * m * ((double)n - L) / (double)taps);
+        h[n] = v / taps;
+    }
+    return h;
+}
+
+// --- IIR ---
+
+// Second order section (RBJ cookbook designs), direct form I. For the places where a few
+// multiplies per sample matter more than linear phase: sub-audio tone filters, notches.
+struct Biquad {
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    double x1 = 0.0, x2 = 0.0, y1 = 0.0, y2 = 0.0;
+
+    static Biquad lowpass(double freq, double q = 0.7071) { return design(freq, q, 0); }
+    static Biquad highpass(double freq, double q = 0.7071) { return design(freq, q, 1); }
+    static Biquad notch(double freq, double q) { return design(freq, q, 2); }
+
+    float process(float in) {
+        double out = b0 * in + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+        x2 = x1; x1 = in;
+        y2 = y1; y1 = out;
+        return (float)out;
+    }
+
+    void reset() { x1 = x2 = y1 = y2 = 0.0; }
+
+    // Takes the coefficients of another design and keeps the state, so a notch can move
+    // without a click
+    void retune(const Biquad& d) { b0 = d.b0; b1 = d.b1; b2 = d.b2; a1 = d.a1; a2 = d.a2; }
+
+private:
+    // freq relative to the sample rate
+    static Biquad design(double freq, double q, int type) {
+        double w = 2.0 * PI * freq, cw = std::cos(w), alpha = std::sin(w) / (2.0 * q);
+        double a0 = 1.0 + alpha;
+        Biquad f;
+        if (type == 0) { f.b0 = f.b2 = (1.0 - cw) / 2.0; f.b1 = 1.0 - cw; }
+        else if (type == 1) { f.b0 = f.b2 = (1.0 + cw) / 2.0; f.b1 = -(1.0 + cw); }
+        else { f.b0 = f.b2 = 1.0; f.b1 = -2.0 * cw; }
+        f.b0 /= a0; f.b1 /= a0; f.b2 /= a0;
+        f.a1 = -2.0 * cw / a0;
+        f.a2 = (1.0 - alpha) / a0;
+        return f;
+    }
+};
+
+// --- COEFFICIENT CACHE ---
+
+// Low-pass specification in Hz. cutoffHz is the -6 dB point, transitionHz the full
+// transition width around it.
+struct FilterSpec {
+    double sampleRate = 0.0;
+    double cutoffHz = 0.0;
+    double transitionHz = 0.0;
+    double attenuationDb = 60.0;
+
+    bool operator<(const FilterSpec& o) const {
+        return std::tie(sampleRate, cutoffHz, transitionHz, attenuationDb)
+             < std::tie(o.sampleRate, o.cutoffHz, o.transitionHz, o.attenuationDb);
+    }
+
+    size_t taps(size_t maxTaps = 4095) const {
+        return std::min(kaiserLength(transitionHz / sampleRate, attenuationDb), maxTaps | 1);
+    }
+};
+
+// Memoized Kaiser low-pass designs keyed by (rate, bandwidth, transition, attenuation), so
+// moving back and forth over the same settings (dragging the bandwidth) doesn't redesign.
+// The cutoff is rounded to 1 Hz to keep slider values from flooding the cache; the least
+// recently used entries are dropped beyond CAPACITY. Thread-safe.
+class FilterCache {
+public:
+    static constexpr size_t CAPACITY = 128;
+    using Taps = std::shared_ptr<const std::vector<double>>;
+
+    static Taps lowpass(FilterSpec spec, size_t maxTaps = 4095) {
+        spec.cutoffHz = std::round(spec.cutoffHz);
+        FilterCache& c = instance();
+        std::lock_guard<std::mutex> lock(c.mtx);
+
+        auto it = c.entries.find(spec);
+        if (it != c.entries.end()) {
+            c.lru.splice(c.lru.begin(), c.lru, it->second.lruPos);
+            return it->second.taps;
+        }
+
+        size_t n = spec.taps(maxTaps);
+        double cutoff = std::min(spec.cutoffHz / spec.sampleRate, 0.5);
+        Taps taps = std::make_shared<const std::vector<double>>(designLowpass(n, cutoff, WindowType::Kaiser, kaiserBeta(spec.attenuationDb)));
+
+        c.lru.push_front(spec);
+        c.entries[spec] = {taps, c.lru.begin()};
+        if (c.entries.size() > CAPACITY) {
+            c.entries.erase(c.lru.back());
+            c.lru.pop_back();
+        }
+        return taps;
+    }
+
+private:
+    struct Entry {
+        Taps taps;
+        std::list<FilterSpec>::iterator lruPos;
+    };
+    std::mutex mtx;
+    std::map<FilterSpec, Entry> entries;
+    std::list<FilterSpec> lru; // most recently used first
+
+    static FilterCache& instance() {
+        static FilterCache cache;
+        return cache;
+    }
+};
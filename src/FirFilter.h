@@ -0,0 +1,178 @@
+#pragma once
+
+#include "DSP.h"
+#include <vector>
+#include <algorithm>
+
+// Streaming complex FIR filter with real taps and a fixed length.
+// Long filters run as overlap-save fast convolution on FFTPlan (cost ~log N per sample),
+// short ones (<= DIRECT_MAX_TAPS) as a direct-form dot product the compiler can vectorize.
+// setTaps() crossfades from the old to the new response over the next block, so redesigning
+// the filter while audio is running (e.g. dragging the bandwidth) doesn't click.
+class FirFilter {
+public:
+    static constexpr size_t DIRECT_MAX_TAPS = 64;
+    static constexpr size_t DIRECT_FADE = 256; // crossfade length in direct form
+
+private:
+    size_t numTaps;
+    bool direct;
+
+    // Direct form: taps time reversed, history stored twice so the window is contiguous
+    std::vector<double> taps, nextTaps;
+    std::vector<Complex> history;
+    size_t pos = 0;
+
+    // Overlap-save: N-point blocks, the last numTaps-1 inputs of a block overlap the next one
+    FFTPlan plan;
+    size_t blockSize = 0;      // N
+    size_t hop = 0;            // new samples per block = N - (numTaps - 1)
+    std::vector<Complex> spectrum, nextSpectrum; // filter response
+    std::vector<Complex> inBlock, work, workNext;
+    std::vector<Complex> outFifo; // outputs of the last block, consumed one per input (latency = hop)
+    size_t fill = 0, outPos = 0;
+
+    bool pending = false;
+    size_t fadeLeft = 0;
+
+    static size_t fftSizeFor(size_t taps) {
+        size_t n = 256;
+        while (n < 4 * taps) n <<= 1;
+        return n;
+    }
+
+    void runBlock(Complex* dst) {
+        std::copy(inBlock.begin(), inBlock.end(), work.begin());
+        plan.forward(work.data());
+        if (pending) std::copy(work.begin(), work.end(), workNext.begin());
+        for (size_t i = 0; i < blockSize; i++) work[i] *= spectrum[i];
+        plan.inverse(work.data());
+
+        const size_t skip = numTaps - 1;
+        const double norm = 1.0 / blockSize;
+        if (!pending) {
+            for (size_t i = 0; i < hop; i++) dst[i] = work[skip + i] * norm;
+        } else {
+            // Linear crossfade old -> new response over this block
+            for (size_t i = 0; i < blockSize; i++) workNext[i] *= nextSpectrum[i];
+            plan.inverse(workNext.data());
+            for (size_t i = 0; i < hop; i++) {
+                double t = (i + 1) / (double)hop;
+                dst[i] = (work[skip + i] * (1.0 - t) + workNext[skip + i] * t) * norm;
+            }
+            spectrum.swap(nextSpectrum);
+            pending = false;
+        }
+        // Keep the overlap for the next block
+        std::copy(inBlock.end() - skip, inBlock.end(), inBlock.begin());
+    }
+
+    Complex dot(const double* h, const Complex* x) const {
+        // Interleaved re/im view keeps the loop a plain multiply-add over doubles
+        const double* xs = reinterpret_cast<const double*>(x);
+        double re = 0.0, im = 0.0;
+        for (size_t j = 0; j < numTaps; j++) { re += h[j] * xs[2 * j]; im += h[j] * xs[2 * j + 1]; }
+        return Complex(re, im);
+    }
+
+public:
+    // Starts as a pure delay of (numTaps - 1) / 2 samples until setTaps() is called
+    explicit FirFilter(size_t length) : numTaps(std::max<size_t>(length, 1)), direct(numTaps <= DIRECT_MAX_TAPS) {
+        std::vector<double> delay(numTaps, 0.0);
+        delay[(numTaps - 1) / 2] = 1.0;
+        if (direct) {
+            taps.resize(numTaps); nextTaps.resize(numTaps);
+            history.assign(2 * numTaps, Complex(0.0, 0.0));
+        } else {
+            blockSize = fftSizeFor(numTaps);
+            hop = blockSize - (numTaps - 1);
+            plan = FFTPlan(blockSize);
+            spectrum.resize(blockSize); nextSpectrum.resize(blockSize);
+            inBlock.assign(blockSize, Complex(0.0, 0.0));
+            work.resize(blockSize); workNext.resize(blockSize);
+            outFifo.assign(hop, Complex(0.0, 0.0));
+        }
+        setTaps(delay.data());
+        pending = false;
+        if (direct) taps.swap(nextTaps);
+        else spectrum.swap(nextSpectrum);
+    }
+
+    size_t length() const { return numTaps; }
+    bool isDirect() const { return direct; }
+
+    // Delay in samples from input to output (group delay of a linear-phase design included)
+    size_t latency() const { return (numTaps - 1) / 2 + (direct ? 0 : hop); }
+
+    // Schedules new taps (exactly length() values). Doesn't allocate.
+    void setTaps(const double* h) {
+        if (direct) {
+            std::reverse_copy(h, h + numTaps, nextTaps.begin());
+            fadeLeft = DIRECT_FADE;
+        } else {
+            std::fill(nextSpectrum.begin(), nextSpectrum.end(), Complex(0.0, 0.0));
+            for (size_t i = 0; i < numTaps; i++) nextSpectrum[i] = Complex(h[i], 0.0);
+            plan.forward(nextSpectrum.data());
+        }
+        pending = true;
+    }
+
+    // Filters count samples; in and out may be the same buffer
+    void process(const Complex* in, Complex* out, size_t count) {
+        if (direct) {
+            for (size_t i = 0; i < count; i++) {
+                history[pos] = history[pos + numTaps] = in[i];
+                if (++pos == numTaps) pos = 0;
+                const Complex* window = &history[pos];
+
+                Complex y = dot(taps.data(), window);
+                if (pending) {
+                    double t = 1.0 - fadeLeft / (double)(DIRECT_FADE + 1);
+                    y = y * (1.0 - t) + dot(nextTaps.data(), window) * t;
+                    if (--fadeLeft == 0) { taps.swap(nextTaps); pending = false; }
+                }
+                out[i] = y;
+            }
+            return;
+        }
+
+        const size_t skip = numTaps - 1;
+        for (size_t i = 0; i < count; i++) {
+            Complex x = in[i];
+            out[i] = outFifo[outPos++];
+            inBlock[skip + fill++] = x;
+            if (fill == hop) {
+                runBlock(outFifo.data());
+                fill = 0;
+                outPos = 0;
+            }
+        }
+    }
+};
+
+// Real FIR in front of a decimator: push() every input sample, output() only when an output
+// sample is due, so the cost is one dot product per output sample.
+class FirDecimator {
+private:
+    std::vector<double> taps; // time reversed
+    std::vector<double> history;
+    size_t numTaps = 1;
+    size_t pos = 0;
+
+public:
+    FirDecimator() : taps(1, 1.0), history(2, 0.0) {}
+    explicit FirDecimator(const std::vector<double>& h)
+        : taps(h.rbegin(), h.rend()), history(2 * h.size(), 0.0), numTaps(h.size()) {}
+
+    void push(double x) {
+        history[pos] = history[pos + numTaps] = x;
+        if (++pos == numTaps) pos = 0;
+    }
+
+    double output() const {
+        const double* w = &history[pos];
+        double acc = 0.0;
+        for (size_t j = 0; j < numTaps; j++) acc += taps[j] * w[j];
+        return acc;
+    }
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "DSP.h"
+#include "FilterDesign.h"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Q15 fixed point (int16, 1.0 = 32768) building blocks for the integer NFM path
+// (-DENABLE_FIXED_POINT): convert, mix, FIR decimate, FM discriminate.
+// Products are accumulated in 32 bits and narrowed with rounding and saturation, exactly what
+// the NEON instructions (vmull / vmlal / vqrshrn) do. Every NEON routine has a scalar
+// ...Reference twin with bit-identical results; it is also what other CPUs run.
+
+inline int16_t saturate16(int64_t x) { return (int16_t)std::clamp<int64_t>(x, -32768, 32767); }
+
+// Rounding shift right by 15, saturated (vqrshrn_n_s32(x, 15))
+inline int16_t roundQ15(int64_t x) { return saturate16((x + (1 << 14)) >> 15); }
+
+// --- CONVERT ---
+
+// Complex samples (+-1.0 full scale) to planar Q15
+inline void convertToQ15(const Complex* in, int16_t* re, int16_t* im, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        re[i] = saturate16((int64_t)std::floor(in[i].real() * 32768.0 + 0.5));
+        im[i] = saturate16((int64_t)std::floor(in[i].imag() * 32768.0 + 0.5));
+    }
+}
+
+// --- MIX ---
+
+// (re + j im) *= (c + j s), in place. |c|, |s| <= 32767, so the 32-bit sums can't overflow.
+inline void complexMulQ15Reference(int16_t* re, int16_t* im, const int16_t* c, const int16_t* s, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int32_t r = (int32_t)re[i] * c[i] - (int32_t)im[i] * s[i];
+        int32_t q = (int32_t)re[i] * s[i] + (int32_t)im[i] * c[i];
+        re[i] = roundQ15(r);
+        im[i] = roundQ15(q);
+    }
+}
+
+inline void complexMulQ15(int16_t* re, int16_t* im, const int16_t* c, const int16_t* s, size_t n) {
+#if defined(__ARM_NEON)
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t a = vld1q_s16(re + i), b = vld1q_s16(im + i);
+        int16x8_t vc = vld1q_s16(c + i), vs = vld1q_s16(s + i);
+        int32x4_t rLo = vmlsl_s16(vmull_s16(vget_low_s16(a), vget_low_s16(vc)), vget_low_s16(b), vget_low_s16(vs));
+        int32x4_t rHi = vmlsl_s16(vmull_s16(vget_high_s16(a), vget_high_s16(vc)), vget_high_s16(b), vget_high_s16(vs));
+        int32x4_t qLo = vmlal_s16(vmull_s16(vget_low_s16(a), vget_low_s16(vs)), vget_low_s16(b), vget_low_s16(vc));
+        int32x4_t qHi = vmlal_s16(vmull_s16(vget_high_s16(a), vget_high_s16(vs)), vget_high_s16(b), vget_high_s16(vc));
+        vst1q_s16(re + i, vcombine_s16(vqrshrn_n_s32(rLo, 15), vqrshrn_n_s32(rHi, 15)));
+        vst1q_s16(im + i, vcombine_s16(vqrshrn_n_s32(qLo, 15), vqrshrn_n_s32(qHi, 15)));
+    }
+    complexMulQ15Reference(re + i, im + i, c + i, s + i, n - i);
+#else
+    complexMulQ15Reference(re, im, c, s, n);
+#endif
+}
+
+// Tuner oscillator: 32-bit phase accumulator, the top TABLE_BITS index the sine table
+// (phase truncation spurs around -72 dBc)
+class NcoQ15 {
+public:
+    static constexpr int TABLE_BITS = 12;
+    static constexpr size_t CHUNK = 64;
+
+    NcoQ15() {
+        for (size_t k = 0; k < (1u << TABLE_BITS); k++) {
+            double a = 2.0 * PI * k / (1u << TABLE_BITS);
+            cosTable[k] = (int16_t)std::lround(32767.0 * std::cos(a));
+            sinTable[k] = (int16_t)std::lround(32767.0 * std::sin(a));
+        }
+    }
+
+    // Frequency in cycles per sample (negative shifts down)
+    void setFrequency(double cyclesPerSample) {
+        step = (uint32_t)(int64_t)std::llround(cyclesPerSample * 4294967296.0);
+    }
+
+    // Planar IQ times e^(j phase), in place
+    void mix(int16_t* re, int16_t* im, size_t n) {
+        int16_t c[CHUNK], s[CHUNK];
+        for (size_t start = 0; start < n; start += CHUNK) {
+            size_t m = std::min(CHUNK, n - start);
+            for (size_t i = 0; i < m; i++) {
+                uint32_t index = phase >> (32 - TABLE_BITS);
+                c[i] = cosTable[index]; s[i] = sinTable[index];
+                phase += step;
+            }
+            complexMulQ15(re + start, im + start, c, s, m);
+        }
+    }
+
+private:
+    uint32_t phase = 0, step = 0;
+    int16_t cosTable[1u << TABLE_BITS], sinTable[1u << TABLE_BITS];
+};
+
+// --- DECIMATE ---
+
+// Dot product with a 32-bit accumulator that wraps (lane order doesn't matter)
+inline int32_t dotQ15Reference(const int16_t* a, const int16_t* b, size_t n) {
+    uint32_t acc = 0;
+    for (size_t i = 0; i < n; i++) acc += (uint32_t)((int32_t)a[i] * b[i]);
+    return (int32_t)acc;
+}
+
+// n: a multiple of 8
+inline int32_t dotQ15(const int16_t* a, const int16_t* b, size_t n) {
+#if defined(__ARM_NEON)
+    int32x4_t acc = vdupq_n_s32(0);
+    for (size_t i = 0; i < n; i += 8) {
+        int16x8_t va = vld1q_s16(a + i), vb = vld1q_s16(b + i);
+        acc = vmlal_s16(acc, vget_low_s16(va), vget_low_s16(vb));
+        acc = vmlal_s16(acc, vget_high_s16(va), vget_high_s16(vb));
+    }
+    uint32x4_t u = vreinterpretq_u32_s32(acc);
+    return (int32_t)(vgetq_lane_u32(u, 0) + vgetq_lane_u32(u, 1) + vgetq_lane_u32(u, 2) + vgetq_lane_u32(u, 3));
+#else
+    return dotQ15Reference(a, b, n);
+#endif
+}
+
+// FIR decimator in Q15 (same scheme as FirDecimator: push every sample, compute output()
+// only when a decimated sample is needed). Taps are rounded to Q15 and zero-padded to a
+// multiple of 8.
+class FirDecimatorQ15 {
+private:
+    std::vector<int16_t> taps; // time reversed
+    std::vector<int16_t> history;
+    size_t numTaps = 8;
+    size_t pos = 0;
+
+public:
+    FirDecimatorQ15() : taps(8, 0), history(16, 0) { taps[7] = 32767; }
+    explicit FirDecimatorQ15(const std::vector<double>& h) { setTaps(h); }
+
+    // New taps of the same (padded) length are swapped in place and keep the delay line, so
+    // the output continues without allocating; another length restarts from silence
+    void setTaps(const std::vector<double>& h) {
+        size_t n = (h.size() + 7) / 8 * 8;
+        if (n != taps.size()) {
+            numTaps = n;
+            taps.assign(numTaps, 0);
+            history.assign(2 * numTaps, 0);
+            pos = 0;
+        }
+        std::fill(taps.begin(), taps.end(), (int16_t)0);
+        for (size_t j = 0; j < h.size(); j++) taps[numTaps - 1 - j] = saturate16(std::lround(h[j] * 32768.0));
+    }
+
+    void push(int16_t x) {
+        history[pos] = history[pos + numTaps] = x;
+        if (++pos == numTaps) pos = 0;
+    }
+
+    int16_t output() const { return roundQ15(dotQ15(taps.data(), &history[pos], numTaps)); }
+    int16_t outputReference() const { return roundQ15(dotQ15Reference(taps.data(), &history[pos], numTaps)); }
+};
+
+// --- DISCRIMINATE ---
+
+// Angles as binary Q15: 32768 = pi, so int16 wraps exactly like the angle
+
+// atan2(y, x); the 9th order polynomial of fastAtan2 in Q15 (error a few LSB, ~1e-4 rad)
+inline int16_t atan2Q15(int64_t y, int64_t x) {
+    int64_t ax = x < 0 ? -x : x, ay = y < 0 ? -y : y;
+    if (ax == 0 && ay == 0) return 0;
+    int64_t hi = std::max(ax, ay), lo = std::min(ax, ay);
+    int64_t t = (lo << 15) / hi;                 // 0 .. 32768
+    int64_t t2 = (t * t + (1 << 14)) >> 15;
+    int64_t r = 217;                             // coefficients / pi in Q15
+    r = ((r * t2 + (1 << 14)) >> 15) - 888;
+    r = ((r * t2 + (1 << 14)) >> 15) + 1879;
+    r = ((r * t2 + (1 << 14)) >> 15) - 3445;
+    r = ((r * t2 + (1 << 14)) >> 15) + 10429;
+    r = (r * t + (1 << 14)) >> 15;               // atan(lo / hi) / pi * 32768
+    if (ay > ax) r = 16384 - r;
+    if (x < 0) r = 32768 - r;
+    if (y < 0) r = -r;
+    return (int16_t)(uint16_t)(r & 0xFFFF);
+}
+
+// Phase step from prev to z (binary Q15 angle)
+inline int16_t phaseStepQ15(int16_t re, int16_t im, int16_t prevRe, int16_t prevIm) {
+    int64_t dotRe = (int64_t)re * prevRe + (int64_t)im * prevIm;
+    int64_t dotIm = (int64_t)im * prevRe - (int64_t)re * prevIm;
+    return atan2Q15(dotIm, dotRe);
+}
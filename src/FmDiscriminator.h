@@ -0,0 +1,59 @@
+#pragma once
+
+#include "DSP.h"
+#include <cmath>
+#include <cstddef>
+
+// FM discriminator variants, from exact to cheapest. All return the phase step between
+// consecutive samples in radians.
+//  - Exact:        std::arg (libm atan2), a function call per sample
+//  - Polynomial:   9th order atan, max error 1.2e-5 rad, branch-free so a block loop vectorizes
+//  - CrossProduct: Im(z * conj(prev)) / (|z| |prev|) with a cubic asin correction, no atan at all.
+//                  Only for small phase steps (< ~0.5 rad: WFM at >= 1 MS/s), wrong near +-pi.
+enum class DiscriminatorType { Exact, Polynomial, CrossProduct };
+
+// atan2 with bounded error (|err| < 1.2e-5 rad), written with selects instead of branches
+inline double fastAtan2(double y, double x) {
+    double ax = std::fabs(x), ay = std::fabs(y);
+    double hi = ax > ay ? ax : ay, lo = ax > ay ? ay : ax;
+    double z = lo / (hi + 1e-300);
+    double z2 = z * z;
+    double r = z * (0.9998660 + z2 * (-0.3302995 + z2 * (0.1801410 + z2 * (-0.0851330 + z2 * 0.0208351))));
+    r = ay > ax ? 0.5 * PI - r : r;
+    r = x < 0.0 ? PI - r : r;
+    return y < 0.0 ? -r : r;
+}
+
+// Phase step from prev to z
+inline double phaseStep(DiscriminatorType type, Complex z, Complex prev) {
+    double re = z.real() * prev.real() + z.imag() * prev.imag();
+    double im = z.imag() * prev.real() - z.real() * prev.imag();
+    switch (type) {
+        case DiscriminatorType::Polynomial: return fastAtan2(im, re);
+        case DiscriminatorType::CrossProduct: {
+            double s = im / (std::sqrt((re * re + im * im)) + 1e-300);
+            return s + s * s * s * (1.0 / 6.0);
+        }
+        default: return std::atan2(im, re);
+    }
+}
+
+// Phase steps of a block: out[i] = step from in[i - 1] to in[i], with in[-1] = last.
+// `last` is updated to the final sample. The type is resolved once, so each loop body is
+// straight-line code.
+inline void discriminate(DiscriminatorType type, const Complex* in, size_t n, Complex& last, double* out) {
+    if (n == 0) return;
+    out[0] = phaseStep(type, in[0], last);
+    switch (type) {
+        case DiscriminatorType::Polynomial:
+            for (size_t i = 1; i < n; i++) out[i] = phaseStep(DiscriminatorType::Polynomial, in[i], in[i - 1]);
+            break;
+        case DiscriminatorType::CrossProduct:
+            for (size_t i = 1; i < n; i++) out[i] = phaseStep(DiscriminatorType::CrossProduct, in[i], in[i - 1]);
+            break;
+        default:
+            for (size_t i = 1; i < n; i++) out[i] = phaseStep(DiscriminatorType::Exact, in[i], in[i - 1]);
+            break;
+    }
+    last = in[n - 1];
+}
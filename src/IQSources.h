@@ -11,6 +11,7 @@
 #include <algorithm> // std::min_element, std::abs
 #include "RingBuffer.h"
 #include "NativeDialogs.h" 
+#include "IqCorrection.h"
 
 #include <rtl-sdr.h>
 
@@ -43,6 +44,13 @@ public:
     virtual bool isSeekable() { return false; } 
     virtual void seek(double percent) {}
     virtual double getProgress() { return 0.0; }
+
+    // DC offset / IQ imbalance correction, applied by each source right after format conversion
+    void setIqCorrection(bool on) { iqCorrection.setEnabled(on); }
+    bool getIqCorrection() const { return iqCorrection.isEnabled(); }
+
+protected:
+    IqCorrection iqCorrection;
 };
 
 // --- FILE SOURCE (WAV) ---
@@ -93,6 +101,7 @@ public:
         for (int i = 0; i < readSamples; i++) {
             out[i] = Complex(buf[i * 2] / 32768.0, buf[i * 2 + 1] / 32768.0);
         }
+        iqCorrection.process(out, readSamples, sampleRate);
 
         currentPos += readSamples * 4; 
         if (file.eof()) { file.clear(); file.seekg(dataStart); currentPos = 0; }
@@ -135,11 +144,13 @@ class RtlSdrSource : public IQSource {
         for (int i = 0; i < samples; i++) {
             converted[i] = Complex((buf[i * 2] - 127.5) / 127.5, (buf[i * 2 + 1] - 127.5) / 127.5);
         }
+        self->iqCorrection.process(converted.data(), samples, self->sampleRate);
         self->ringBuffer.push(converted.data(), samples);
     }
 
 public:
-    RtlSdrSource() : ringBuffer(1024 * 1024) {} 
+    // On by default: the dongles have a DC spike and a visible image
+    RtlSdrSource() : ringBuffer(1024 * 1024) { iqCorrection.setEnabled(true); } 
     ~RtlSdrSource() { close(); }
 
     bool open(std::string id, uint32_t requestedRate = 0) override {
@@ -253,6 +264,7 @@ class SdrPlaySource : public IQSource {
             for (unsigned int i = 0; i < chunk; i++) {
                 tempBuf[i] = Complex(xi[processed + i] / 32768.0, xq[processed + i] / 32768.0);
             }
+            self->iqCorrection.process(tempBuf, chunk, self->sampleRate);
             self->ringBuffer.push(tempBuf, chunk);
             processed += chunk;
         }
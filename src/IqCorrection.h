@@ -0,0 +1,85 @@
+#pragma once
+
+#include "DSP.h"
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+// Front-end correction for direct conversion receivers (RTL-SDR), run by the source right
+// after format conversion:
+//  - DC offset: one-pole IIR on the chunk mean (0.1 s, a notch ~1.6 Hz wide at 0 Hz),
+//  - IQ imbalance, blind: with a balanced front end I and Q have equal power and no
+//    correlation. From leaky averages (1 s) of I^2, Q^2 and I*Q, Q is orthogonalized
+//    (Q -= p * I, p = E[IQ] / E[I^2]) and scaled to the power of I. This removes the image
+//    of every signal at once.
+// Estimates are updated once per CHUNK; the per-sample work is a handful of multiply-adds
+// on the interleaved doubles, in loops the compiler vectorizes.
+// setEnabled() may be called from any thread; the processing thread picks it up.
+class IqCorrection {
+public:
+    static constexpr size_t CHUNK = 256;
+
+    void setEnabled(bool on) { enabled = on; }
+    bool isEnabled() const { return enabled; }
+
+    // Estimated front-end errors (processing thread), for a front end that delivers
+    // Q' = gain * (Q cos(phase) + I sin(phase)): then p = gain sin(phase), 1 / g = gain cos(phase)
+    Complex dcOffset() const { return Complex(dcI, dcQ); }
+    double phaseErrorDeg() const { return std::atan(p * g) * 180.0 / PI; }
+    double gainErrorDb() const { return 10.0 * std::log10(p * p + 1.0 / (g * g)); }
+
+    void process(Complex* buffer, size_t count, double sampleRate) {
+        if (!enabled) { active = false; return; }
+        if (!active || sampleRate != rate) start(sampleRate);
+
+        double* d = reinterpret_cast<double*>(buffer);
+        for (size_t s = 0; s < count; s += CHUNK) {
+            size_t n = std::min(CHUNK, count - s);
+            double* x = d + 2 * s;
+
+            double sumI = 0.0, sumQ = 0.0;
+            for (size_t i = 0; i < n; i++) { sumI += x[2 * i]; sumQ += x[2 * i + 1]; }
+            dcI += dcAlpha * (sumI / n - dcI);
+            dcQ += dcAlpha * (sumQ / n - dcQ);
+
+            double ii = 0.0, qq = 0.0, iq = 0.0;
+            for (size_t i = 0; i < n; i++) {
+                double vi = x[2 * i] - dcI, vq = x[2 * i + 1] - dcQ;
+                ii += vi * vi; qq += vq * vq; iq += vi * vq;
+            }
+            powI += imbAlpha * (ii / n - powI);
+            powQ += imbAlpha * (qq / n - powQ);
+            cross += imbAlpha * (iq / n - cross);
+            if (powI > 1e-20) {
+                p = cross / powI;
+                double orthogonal = powQ - cross * p; // power of Q - p * I
+                g = orthogonal > 1e-20 ? std::sqrt(powI / orthogonal) : 1.0;
+            }
+
+            const double ci = dcI, cq = dcQ, pp = p, gg = g;
+            for (size_t i = 0; i < n; i++) {
+                double vi = x[2 * i] - ci, vq = x[2 * i + 1] - cq;
+                x[2 * i] = vi;
+                x[2 * i + 1] = gg * (vq - pp * vi);
+            }
+        }
+    }
+
+private:
+    std::atomic<bool> enabled {false};
+    bool active = false;
+    double rate = 0.0, dcAlpha = 0.0, imbAlpha = 0.0;
+    double dcI = 0.0, dcQ = 0.0;
+    double powI = 0.0, powQ = 0.0, cross = 0.0;
+    double p = 0.0, g = 1.0;
+
+    void start(double sampleRate) {
+        rate = sampleRate;
+        double chunkSec = CHUNK / std::max(rate, 1.0);
+        dcAlpha = 1.0 - std::exp(-chunkSec / 0.1);
+        imbAlpha = 1.0 - std::exp(-chunkSec / 1.0);
+        dcI = dcQ = 0.0; powI = powQ = cross = 0.0; p = 0.0; g = 1.0;
+        active = true;
+    }
+};
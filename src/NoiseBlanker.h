@@ -0,0 +1,132 @@
+#pragma once
+
+#include "DSP.h"
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+// Impulse noise blanker settings. A sample is an impulse when its power is thresholdDb above
+// the running average power of the raw IQ.
+struct NoiseBlankerSettings {
+    bool enabled = false;
+    float thresholdDb = 12.0f;  // Gaussian noise crosses it about once per 10^7 samples
+    float averageMs = 10.0f;    // power tracker time constant
+    float guardUs = 5.0f;       // also blanked on both sides of an impulse (front-end ringing)
+    float maxBlankMs = 1.0f;    // longer "impulses" are a new signal: the tracker jumps to it
+    bool interpolate = true;    // bridge the gap linearly, otherwise zero it
+
+    bool operator==(const NoiseBlankerSettings& o) const {
+        return enabled == o.enabled && thresholdDb == o.thresholdDb && averageMs == o.averageMs
+            && guardUs == o.guardUs && maxBlankMs == o.maxBlankMs && interpolate == o.interpolate;
+    }
+};
+
+// Blanker for broadband impulses (ignition, power line) on the raw IQ, ahead of the tuner.
+// Work is done in CHUNKs: the power of the chunk is computed and compared against the
+// threshold in straight loops the compiler vectorizes, and the running average is updated
+// once per chunk. Only chunks with an impulse (or a guard carried over) take the per-sample
+// path. Each Demodulator owns one.
+class NoiseBlanker {
+public:
+    static constexpr size_t CHUNK = 64;
+    NoiseBlankerSettings settings;
+    unsigned long long blanked = 0; // samples blanked so far
+
+    // Also re-derives the rate dependent constants from the settings on the next block
+    void reset() { rate = 0.0; average = -1.0; guardLeft = 0; runLength = 0; lastGood = Complex(0, 0); }
+
+    // Copies in[0, n) to out with impulses removed; out may be in
+    void process(const Complex* in, Complex* out, size_t n, double sampleRate) {
+        if (sampleRate != rate) setRate(sampleRate);
+        const float limitFactor = std::pow(10.0f, settings.thresholdDb / 10.0f);
+
+        for (size_t start = 0; start < n; start += CHUNK) {
+            size_t m = std::min(CHUNK, n - start);
+            const Complex* x = in + start;
+            Complex* y = out + start;
+
+            double total = 0.0;
+            for (size_t i = 0; i < m; i++) {
+                power[i] = std::norm(x[i]);
+                total += power[i];
+            }
+            if (average < 0.0) average = total / m; // first chunk seeds the tracker
+
+            double limit = average * limitFactor;
+            int hits = 0;
+            for (size_t i = 0; i < m; i++) hits += power[i] > limit;
+
+            if (hits == 0 && guardLeft == 0) {
+                if (y != x) std::copy(x, x + m, y);
+                average += chunkAlpha * (total / m - average);
+                lastGood = x[m - 1];
+                runLength = 0;
+                continue;
+            }
+            blankChunk(x, y, m, limit);
+        }
+    }
+
+private:
+    double rate = 0.0;
+    double chunkAlpha = 0.0;
+    int guardSamples = 0, maxRun = 0;
+    double average = -1.0;
+    int guardLeft = 0, runLength = 0;
+    Complex lastGood = Complex(0, 0);
+    double power[CHUNK];
+    bool mask[CHUNK];
+
+    void setRate(double sampleRate) {
+        reset();
+        rate = sampleRate;
+        chunkAlpha = 1.0 - std::exp(-(double)CHUNK / (settings.averageMs * 1e-3 * rate));
+        guardSamples = (int)std::lround(settings.guardUs * 1e-6 * rate);
+        maxRun = std::max(1, (int)(settings.maxBlankMs * 1e-3 * rate));
+    }
+
+    // Per-sample path: mark impulses plus guard, carry the guard into the next chunk, then fill
+    void blankChunk(const Complex* x, Complex* y, size_t m, double limit) {
+        std::fill(mask, mask + m, false);
+        for (size_t i = 0; i < m; i++) {
+            if (power[i] > limit) {
+                size_t from = i > (size_t)guardSamples ? i - guardSamples : 0;
+                std::fill(mask + from, mask + i, true);
+                guardLeft = guardSamples + 1;
+            }
+            if (guardLeft > 0) { mask[i] = true; guardLeft--; }
+        }
+
+        // Signal power of the clean samples keeps the tracker going
+        double clean = 0.0; int cleanCount = 0;
+        for (size_t i = 0; i < m; i++) if (!mask[i]) { clean += power[i]; cleanCount++; }
+        if (cleanCount > 0) average += chunkAlpha * cleanCount / m * (clean / cleanCount - average);
+
+        // A step up in level that doesn't go away is not an impulse
+        runLength = cleanCount == 0 ? runLength + (int)m : 0;
+        if (runLength > maxRun) {
+            double total = 0.0;
+            for (size_t i = 0; i < m; i++) total += power[i];
+            average = total / m;
+            guardLeft = 0; runLength = 0;
+            if (y != x) std::copy(x, x + m, y);
+            lastGood = x[m - 1];
+            return;
+        }
+
+        for (size_t i = 0; i < m;) {
+            if (!mask[i]) { y[i] = x[i]; lastGood = x[i]; i++; continue; }
+            size_t end = i;
+            while (end < m && mask[end]) end++;
+            // Gap [i, end): a line from the last good sample to the next one (within the chunk)
+            Complex next = end < m ? x[end] : lastGood;
+            size_t len = end - i;
+            for (size_t j = 0; j < len; j++) {
+                double t = (double)(j + 1) / (len + 1);
+                y[i + j] = settings.interpolate ? lastGood + (next - lastGood) * t : Complex(0, 0);
+            }
+            blanked += len;
+            i = end;
+        }
+    }
+};
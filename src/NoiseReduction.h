@@ -0,0 +1,104 @@
+#pragma once
+
+#include "DSP.h"
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+// Audio noise reduction settings. strength 0..1 sets both the noise overestimate (1x .. 2x)
+// and the gain floor (-6 .. -30 dB): higher removes more hiss, with more artifacts.
+struct NoiseReductionSettings {
+    bool enabled = false;
+    float strength = 0.5f;
+
+    bool operator==(const NoiseReductionSettings& o) const {
+        return enabled == o.enabled && strength == o.strength;
+    }
+};
+
+// Spectral noise reduction (Wiener filter) for narrowband audio. Short-time spectra of ~10 ms
+// frames (sqrt-Hann windows, 50% overlap-add, RealFFTPlan) get a gain per bin from
+//  - the noise floor: the minimum of the smoothed bin power, rising slowly when it moves up,
+//  - the a priori SNR, decision-directed (Ephraim-Malah), which keeps "musical noise" down.
+// Latency is one frame (512 samples at 48 kHz = 10.7 ms). Each Demodulator owns one.
+class NoiseReduction {
+public:
+    NoiseReductionSettings settings;
+
+    // Clears the audio and noise estimate (no allocation)
+    void reset() {
+        std::fill(history.begin(), history.end(), 0.0); std::fill(ola.begin(), ola.end(), 0.0);
+        std::fill(lastGain2.begin(), lastGain2.end(), 1.0); std::fill(lastPost.begin(), lastPost.end(), 1.0);
+        fill = 0; primed = false;
+    }
+
+    // In place; the output is delayed by frameSize() samples
+    void process(float* audio, size_t count, double sampleRate) {
+        if (sampleRate != rate) setRate(sampleRate);
+        for (size_t i = 0; i < count; i++) {
+            float x = audio[i];
+            audio[i] = (float)ola[fill];
+            history[hop + fill] = x;
+            if (++fill == hop) { processFrame(); fill = 0; }
+        }
+    }
+
+    size_t frameSize() const { return frame; }
+
+private:
+    static constexpr double RISE_DB_PER_S = 3.0; // noise floor tracking upwards
+    static constexpr double DD_ALPHA = 0.98;     // decision-directed smoothing
+    static constexpr double MIN_BIAS = 2.0;      // the tracked minimum sits below the mean noise power
+
+    double rate = 0.0;
+    size_t frame = 512, hop = 256, fill = 0;
+    RealFFTPlan plan;
+    std::vector<double> window, history, ola, work;
+    std::vector<Complex> spec;
+    std::vector<double> smoothed, noise, lastGain2, lastPost;
+    double rise = 1.0;
+    bool primed = false;
+
+    void setRate(double sampleRate) {
+        rate = sampleRate;
+        frame = 16;
+        while (frame < 0.01 * rate) frame <<= 1;
+        hop = frame / 2;
+        plan = RealFFTPlan(frame);
+        // Periodic sqrt-Hann for analysis and synthesis: the squares overlap-add to 1
+        window.resize(frame);
+        for (size_t i = 0; i < frame; i++) window[i] = std::sin(PI * i / frame);
+        history.resize(frame); ola.resize(frame); work.resize(frame);
+        spec.resize(plan.bins()); smoothed.resize(plan.bins()); noise.resize(plan.bins());
+        lastGain2.resize(plan.bins()); lastPost.resize(plan.bins());
+        rise = std::pow(10.0, RISE_DB_PER_S * hop / rate / 10.0);
+        reset();
+    }
+
+    void processFrame() {
+        for (size_t i = 0; i < frame; i++) work[i] = history[i] * window[i];
+        plan.forward(work.data(), spec.data());
+
+        const double over = MIN_BIAS * (1.0 + settings.strength);
+        const double floorGain = std::pow(10.0, -(6.0 + 24.0 * settings.strength) / 20.0);
+        for (size_t k = 0; k < spec.size(); k++) {
+            double power = std::norm(spec[k]);
+            smoothed[k] = primed ? 0.7 * smoothed[k] + 0.3 * power : power;
+            noise[k] = primed ? std::min(noise[k] * rise, smoothed[k]) : smoothed[k];
+
+            double post = power / (over * noise[k] + 1e-30);
+            double prio = DD_ALPHA * lastGain2[k] * lastPost[k] + (1.0 - DD_ALPHA) * std::max(post - 1.0, 0.0);
+            double gain = std::max(prio / (1.0 + prio), floorGain);
+            lastGain2[k] = gain * gain; lastPost[k] = post;
+            spec[k] *= gain;
+        }
+        primed = true;
+
+        plan.inverse(spec.data(), work.data());
+        const double scale = 1.0 / frame;
+        for (size_t i = 0; i < hop; i++) ola[i] = ola[hop + i] + work[i] * window[i] * scale;
+        for (size_t i = hop; i < frame; i++) ola[i] = work[i] * window[i] * scale;
+        std::copy(history.begin() + hop, history.end(), history.begin());
+    }
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include <vector>
+#include <string>
+#include <chrono>
+#include <ostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstdint>
+
+// Dataflow graph for the receive chain: nodes (source, demodulators, sinks...) joined by typed
+// streams of fixed capacity. A node works on what its inputs hold and its outputs have room
+// for; a full output stops it (back-pressure) until its readers have consumed.
+// Scheduling runs on the ThreadPool: nodes get a level (1 + the highest level upstream),
+// nodes of one level don't depend on each other and run in parallel, levels run in order.
+// That also makes the streams race free without atomics: a producer always runs in another
+// wave than its readers.
+
+// Buffer between one producer and any number of readers. Data stays contiguous: the writer
+// compacts (drops what every reader has consumed) before it asks for space.
+template <typename T>
+class Stream {
+private:
+    std::vector<T> buffer;
+    size_t end = 0;              // items written
+    std::vector<size_t> readers; // read position of every reader
+
+    void compact() {
+        size_t low = end;
+        for (size_t r : readers) low = std::min(low, r);
+        if (low == 0) return;
+        std::move(buffer.begin() + low, buffer.begin() + end, buffer.begin());
+        end -= low;
+        for (size_t& r : readers) r -= low;
+    }
+
+public:
+    size_t addReader() { readers.push_back(end); return readers.size() - 1; }
+
+    // Writer side. capacity only grows (when the block size does).
+    void reserve(size_t capacity) { if (capacity > buffer.size()) buffer.resize(capacity); }
+    size_t space() { compact(); return buffer.size() - end; }
+    T* writePtr() { return buffer.data() + end; }
+    void commit(size_t n) { end += n; }
+
+    // Reader side
+    size_t available(size_t reader) const { return end - readers[reader]; }
+    const T* readPtr(size_t reader) const { return buffer.data() + readers[reader]; }
+    void consume(size_t reader, size_t n) { readers[reader] += n; }
+
+    void clear() { end = 0; std::fill(readers.begin(), readers.end(), 0); }
+};
+
+class Node;
+
+template <typename T>
+struct OutputPort {
+    Node* owner;
+    Stream<T> stream;
+
+    explicit OutputPort(Node* n, size_t capacity = 0) : owner(n) { stream.reserve(capacity); }
+    void reserve(size_t capacity) { stream.reserve(capacity); }
+    size_t space() { return stream.space(); }
+    T* data() { return stream.writePtr(); }
+    void commit(size_t n) { stream.commit(n); }
+};
+
+template <typename T>
+struct InputPort {
+    Node* owner;
+    Stream<T>* stream = nullptr; // nullptr: not connected, reads as empty
+    size_t reader = 0;
+
+    explicit InputPort(Node* n) : owner(n) {}
+    size_t available() const { return stream ? stream->available(reader) : 0; }
+    const T* data() const { return stream->readPtr(reader); }
+    void consume(size_t n) { stream->consume(reader, n); }
+};
+
+// Per node counters, for profiling stage by stage
+struct NodeStats {
+    uint64_t calls = 0;   // work() calls that made progress
+    uint64_t items = 0;   // items they reported
+    double seconds = 0.0; // time spent in work(), idle calls included
+};
+
+class Node {
+public:
+    const std::string name;
+    NodeStats stats;
+
+    explicit Node(std::string n) : name(std::move(n)) {}
+    virtual ~Node() = default;
+
+    // Processes what the inputs hold and the outputs have room for; returns the number of
+    // items consumed or produced, 0 when there was nothing to do
+    virtual size_t work() = 0;
+
+private:
+    friend class Pipeline;
+    std::vector<Node*> upstream;
+    int level = 0;
+    size_t lastWork = 0;
+};
+
+// Nodes are not owned; they must outlive the pipeline. The graph must be acyclic.
+class Pipeline {
+private:
+    ThreadPool& pool;
+    std::vector<Node*> nodes;
+    std::vector<std::vector<Node*>> levels;
+    bool dirty = true;
+
+    void computeLevels() {
+        // Longest path from a source, relaxed until stable (graphs here are a handful of nodes)
+        for (Node* n : nodes) n->level = 0;
+        for (bool changed = true; changed;) {
+            changed = false;
+            for (Node* n : nodes) {
+                for (Node* u : n->upstream) {
+                    if (u->level + 1 > n->level) { n->level = u->level + 1; changed = true; }
+                }
+            }
+        }
+        int maxLevel = 0;
+        for (Node* n : nodes) maxLevel = std::max(maxLevel, n->level);
+        levels.assign(maxLevel + 1, {});
+        for (Node* n : nodes) levels[n->level].push_back(n);
+        dirty = false;
+    }
+
+    static void runTimed(Node& n) {
+        auto t0 = std::chrono::steady_clock::now();
+        n.lastWork = n.work();
+        n.stats.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        if (n.lastWork > 0) { n.stats.calls++; n.stats.items += n.lastWork; }
+    }
+
+public:
+    explicit Pipeline(ThreadPool& p) : pool(p) {}
+
+    void add(Node& n) {
+        if (std::find(nodes.begin(), nodes.end(), &n) == nodes.end()) nodes.push_back(&n);
+        dirty = true;
+    }
+
+    template <typename T>
+    void connect(OutputPort<T>& out, InputPort<T>& in) {
+        add(*out.owner); add(*in.owner);
+        in.stream = &out.stream;
+        in.reader = out.stream.addReader();
+        in.owner->upstream.push_back(out.owner);
+    }
+
+    // Passes over the graph until no node makes progress; returns the total progress
+    size_t run() {
+        if (dirty) computeLevels();
+        size_t total = 0;
+        while (true) {
+            size_t progress = 0;
+            for (auto& level : levels) {
+                pool.parallelFor(level.size(), [&](size_t i) { runTimed(*level[i]); });
+                for (Node* n : level) progress += n->lastWork;
+            }
+            if (progress == 0) return total;
+            total += progress;
+        }
+    }
+
+    void printProfile(std::ostream& os) const {
+        os << "Pipeline profile:\n";
+        for (const Node* n : nodes) {
+            os << "  " << std::left << std::setw(14) << n->name << std::right
+               << std::fixed << std::setprecision(3) << std::setw(10) << n->stats.seconds << " s "
+               << std::setw(10) << n->stats.calls << " calls "
+               << std::setw(14) << n->stats.items << " items";
+            if (n->stats.items > 0) os << "  " << std::setprecision(1) << 1e9 * n->stats.seconds / n->stats.items << " ns/item";
+            os << "\n";
+        }
+        os.unsetf(std::ios::floatfield);
+    }
+};
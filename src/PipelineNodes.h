@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Pipeline.h"
+#include "IQSources.h"
+#include "VfoBank.h"
+#include "AudioSink.h"
+#include "WavWriter.h"
+#include "Channelizer.h"
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+// Pipeline nodes around the existing receiver parts. Each one only wraps a part; the part
+// itself (source, bank, sink, writer) still belongs to whoever created it.
+
+// --- SOURCE ---
+
+// Reads one block per request() from the current IQSource
+class SourceNode : public Node {
+public:
+    OutputPort<Complex> out {this};
+    std::shared_ptr<IQSource> source;
+    size_t lastRead = 0; // samples of the latest block
+
+    SourceNode() : Node("source") {}
+
+    // The next run() reads up to count samples (once there is room for them)
+    void request(size_t count) { pending = count; lastRead = 0; out.reserve(count); }
+
+    size_t work() override {
+        if (!source || pending == 0 || out.space() < pending) return 0;
+        int n = source->read(out.data(), (int)pending);
+        pending = 0;
+        if (n <= 0) return 0;
+        out.commit(n);
+        lastRead = n;
+        return n;
+    }
+
+private:
+    size_t pending = 0;
+};
+
+// --- BASEBAND RECORDER ---
+
+// Writes the IQ to a stereo WAV while the writer is active, otherwise discards it
+class IqRecorderNode : public Node {
+public:
+    InputPort<Complex> in {this};
+
+    explicit IqRecorderNode(WavWriter& w, std::string name = "iq recorder") : Node(std::move(name)), writer(w) {}
+
+    size_t work() override {
+        size_t n = in.available();
+        if (n == 0) return 0;
+        if (writer.active) {
+            // convert IQ (Complex) to float array (L R L R)
+            if (interleaved.size() < 2 * n) interleaved.resize(2 * n);
+            const Complex* iq = in.data();
+            for (size_t i = 0; i < n; i++) {
+                interleaved[2 * i] = (float)iq[i].real();
+                interleaved[2 * i + 1] = (float)iq[i].imag();
+            }
+            writer.write(interleaved.data(), 2 * n);
+        }
+        in.consume(n);
+        return n;
+    }
+
+private:
+    WavWriter& writer;
+    std::vector<float> interleaved;
+};
+
+// --- CHANNELIZER ---
+
+// Splits the IQ into channels (Channelizer, at least MIN_SPACING_HZ apart, 2x oversampled)
+// and sends up to MAX_OUTPUTS selected ones on as narrowband IQ, one stream each. Does no
+// filtering while nothing is selected.
+class ChannelizerNode : public Node {
+public:
+    static constexpr size_t MAX_OUTPUTS = 4;
+    static constexpr double MIN_SPACING_HZ = 25000.0;
+    InputPort<Complex> in {this};
+    std::vector<OutputPort<Complex>> out; // MAX_OUTPUTS, fixed once connected
+
+    ChannelizerNode() : Node("channelizer") {
+        out.reserve(MAX_OUTPUTS);
+        for (size_t i = 0; i < MAX_OUTPUTS; i++) out.emplace_back(this);
+    }
+
+    // Output i carries the channel containing offsetsHz[i] (relative to the center frequency),
+    // at most MAX_OUTPUTS; an empty list stops the channelizer. Call between runs.
+    void select(const std::vector<double>& offsetsHz, double sampleRate) {
+        if (!offsetsHz.empty() && (!channelizer || sampleRate != rate)) {
+            size_t channels = 2;
+            while (sampleRate / (channels * 2) >= MIN_SPACING_HZ) channels *= 2;
+            channelizer = std::make_unique<Channelizer>(channels, channels / 2);
+            rate = sampleRate;
+        }
+        for (size_t i = 0; i < MAX_OUTPUTS; i++) {
+            selected[i] = i < offsetsHz.size() ? (int)channelizer->channelFor(offsetsHz[i], rate) : -1;
+        }
+    }
+
+    // Of the current selection
+    double channelRate() const { return channelizer ? channelizer->channelRate(rate) : 0.0; }
+    double channelCenter(size_t output) const {
+        return selected[output] >= 0 ? channelizer->channelCenter(selected[output], rate) : 0.0;
+    }
+
+    size_t work() override {
+        size_t n = in.available();
+        if (n == 0) return 0;
+        bool active = std::any_of(selected, selected + MAX_OUTPUTS, [](int k) { return k >= 0; });
+        if (!active) { in.consume(n); return n; }
+
+        size_t stride = channelizer->maxOutput(n);
+        for (size_t i = 0; i < MAX_OUTPUTS; i++) {
+            if (selected[i] < 0) continue;
+            out[i].reserve(stride);
+            if (out[i].space() < stride) return 0;
+        }
+        if (frames.size() < channelizer->numChannels() * stride) frames.resize(channelizer->numChannels() * stride);
+        size_t produced = channelizer->process(in.data(), n, frames.data(), stride);
+        for (size_t i = 0; i < MAX_OUTPUTS; i++) {
+            if (selected[i] < 0) continue;
+            const Complex* channel = frames.data() + selected[i] * stride;
+            std::copy(channel, channel + produced, out[i].data());
+            out[i].commit(produced);
+        }
+        in.consume(n);
+        return n;
+    }
+
+private:
+    std::unique_ptr<Channelizer> channelizer;
+    double rate = 0.0;
+    int selected[MAX_OUTPUTS] = {-1, -1, -1, -1};
+    std::vector<Complex> frames; // channel k at k * stride
+};
+
+// --- DEMODULATORS ---
+
+// Every VFO of the bank (one Demodulator each) on the IQ; the mixed audio goes out as left /
+// right. Waits while the audio streams have no room for a whole block.
+class VfoBankNode : public Node {
+public:
+    InputPort<Complex> in {this};
+    OutputPort<float> left {this}, right {this};
+
+    explicit VfoBankNode(VfoBank& b) : Node("demod"), bank(b) {}
+
+    size_t work() override {
+        size_t n = in.available();
+        if (n == 0) return 0;
+        size_t need = bank.maxOutput(n);
+        left.reserve(need); right.reserve(need);
+        if (left.space() < need || right.space() < need) return 0;
+        size_t count = bank.process(in.data(), n, left.data(), right.data(), need);
+        left.commit(count); right.commit(count);
+        in.consume(n);
+        return n;
+    }
+
+private:
+    VfoBank& bank;
+};
+
+// --- AUDIO OUTPUT ---
+
+class AudioSinkNode : public Node {
+public:
+    InputPort<float> left {this}, right {this};
+
+    explicit AudioSinkNode(AudioSink& s) : Node("audio out"), sink(s) {}
+
+    size_t work() override {
+        size_t n = std::min(left.available(), right.available());
+        if (n == 0) return 0;
+        sink.pushStereo(left.data(), right.data(), n);
+        left.consume(n); right.consume(n);
+        return n;
+    }
+
+private:
+    AudioSink& sink;
+};
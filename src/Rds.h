@@ -0,0 +1,277 @@
+#pragma once
+
+#include "DSP.h"
+#include "FilterDesign.h"
+#include "FirFilter.h"
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+// Decoded RDS/RBDS fields. Text is kept in fixed-size arrays, so copying the struct to the
+// UI doesn't allocate.
+struct RdsInfo {
+    bool hasPi = false;
+    uint16_t pi = 0;
+    int pty = 0;
+    char ps[9];      // Program Service name, 8 characters
+    char rt[65];     // RadioText, up to 64 characters
+    char ct[32];     // Clock time (local), empty until received
+    bool psComplete = false, rtComplete = false; // every segment of the current text received
+    uint32_t groups = 0; // valid groups decoded so far
+
+    RdsInfo() { clear(); }
+
+    void clear() {
+        hasPi = false; pi = 0; pty = 0; groups = 0;
+        psComplete = rtComplete = false;
+        std::memset(ps, ' ', 8); ps[8] = 0;
+        std::memset(rt, ' ', 64); rt[64] = 0;
+        ct[0] = 0;
+    }
+};
+
+// RDS decoder fed with the WFM multiplex (MPX) at the multiplex rate:
+// 57 kHz mix -> ~20 kHz complex baseband (FIR decimator) -> Costas loop (BPSK carrier) ->
+// biphase matched filter with early/late bit timing -> differential decoding ->
+// 26-bit block sync with CRC/offset words -> group decoding (PI, PTY, PS, RT, CT).
+// Costs a few hundred multiply-adds per baseband sample, a small fraction of the WFM path.
+class RdsDecoder {
+public:
+    RdsInfo info;
+
+    explicit RdsDecoder(double mpxRate = 240000.0) : rate(mpxRate) {
+        decimation = std::max(1, (int)(rate / 19000.0));
+        basebandRate = rate / decimation;
+        oscStep = std::polar(1.0, -2.0 * PI * 57000.0 / rate);
+
+        // RDS occupies +-2.4 kHz around 57 kHz; the pilot (19 kHz away) and L-R must go
+        std::vector<double> h = designLowpass(kaiserLength(3000.0 / rate, 50.0), 3000.0 / rate, WindowType::Kaiser, kaiserBeta(50.0));
+        lpfI = FirDecimator(h);
+        lpfQ = FirDecimator(h);
+
+        double wn = 2.0 * PI * 20.0 / basebandRate;
+        costasKp = 2.0 * 0.707 * wn;
+        costasKi = wn * wn;
+        samplesPerBit = basebandRate / 1187.5;
+        half = std::max(1, (int)std::lround(samplesPerBit / 2.0));
+    }
+
+    void reset() {
+        info.clear();
+        synced = false; reg = 0; bitCount = 0; lastFound = -1;
+        rtFlag = -1; psMask = 0; rtMask = 0; rtSegments = 16;
+    }
+
+    // One MPX sample (1.0 = full deviation)
+    void push(double mpx) {
+        Complex mixed = mpx * osc;
+        osc *= oscStep;
+        lpfI.push(mixed.real());
+        lpfQ.push(mixed.imag());
+        if (++decimCount < decimation) return;
+        decimCount = 0;
+        osc /= std::abs(osc);
+        demodulate(Complex(lpfI.output(), lpfQ.output()));
+    }
+
+private:
+    double rate, basebandRate;
+    int decimation, decimCount = 0;
+    Complex osc = Complex(1.0, 0.0), oscStep;
+    FirDecimator lpfI, lpfQ;
+
+    // Costas loop
+    double carrierPhase = 0.0, carrierFreq = 0.0, costasKp, costasKi;
+
+    // Biphase matched filter over the last 2 * half samples (running sums), bit clock
+    static constexpr int HIST = 64;
+    float hist[HIST] = {};
+    int histPos = 0;
+    double firstHalf = 0.0, secondHalf = 0.0;
+    int half;
+    double samplesPerBit, bitPhase = 0.0;
+    double mf[3] = {0.0, 0.0, 0.0}; // matched filter output at n-2, n-1, n
+    int prevSymbol = 0;
+
+    // Block sync
+    uint32_t reg = 0;
+    long long bitCount = 0, lastFound = -1;
+    int lastFoundPos = 0;
+    bool synced = false;
+    int blockPos = 0, bitsToBlock = 0, badBlocks = 0;
+    uint16_t blocks[4] = {};
+    bool blockOk[4] = {};
+    int rtFlag = -1;
+    unsigned psMask = 0, rtMask = 0; // received text segments
+    int rtSegments = 16;             // segments up to the 0x0D end marker
+
+    void demodulate(Complex z) {
+        // BPSK carrier recovery; the error is normalized so the loop gain doesn't depend on level
+        Complex y = z * std::polar(1.0, -carrierPhase);
+        double err = y.real() * y.imag() / (std::norm(y) + 1e-12);
+        carrierFreq = std::clamp(carrierFreq + costasKi * err, -0.01, 0.01);
+        carrierPhase = std::fmod(carrierPhase + carrierFreq + costasKp * err, 2.0 * PI);
+
+        // Biphase matched filter: +first half of the bit, -second half
+        float r = (float)y.real();
+        float leaving = hist[(histPos - 2 * half + HIST) % HIST];
+        float middle = hist[(histPos - half + HIST) % HIST];
+        firstHalf += middle - leaving;
+        secondHalf += r - middle;
+        hist[histPos] = r;
+        histPos = (histPos + 1) % HIST;
+        mf[0] = mf[1]; mf[1] = mf[2]; mf[2] = firstHalf - secondHalf;
+
+        // Bit strobe one sample late, so the samples on both sides are known (early/late gate)
+        bitPhase += 1.0 / samplesPerBit;
+        if (bitPhase < 1.0) return;
+        bitPhase -= 1.0;
+        double early = std::abs(mf[0]), late = std::abs(mf[2]), peak = std::abs(mf[1]);
+        bitPhase -= 0.1 * (late - early) / (peak + early + late + 1e-12);
+
+        int symbol = mf[1] > 0.0 ? 1 : 0;
+        receiveBit(symbol ^ prevSymbol);
+        prevSymbol = symbol;
+    }
+
+    // --- BLOCKS ---
+    static constexpr uint16_t OFFSETS[5] = {0x0FC, 0x198, 0x168, 0x1B4, 0x350}; // A, B, C, D, C'
+
+    static uint16_t checkword(uint16_t data) {
+        uint32_t r = (uint32_t)data << 10;
+        for (int i = 25; i >= 10; i--) if (r & (1u << i)) r ^= 0x5B9u << (i - 10);
+        return (uint16_t)(r & 0x3FF);
+    }
+
+    // Block position (0..3, C' counts as 2) the 26-bit word is valid for, or -1
+    static int matchOffset(uint32_t word, int onlyPos = -1) {
+        uint16_t syndrome = checkword((uint16_t)(word >> 10)) ^ (uint16_t)(word & 0x3FF);
+        for (int i = 0; i < 5; i++) {
+            int pos = (i == 4) ? 2 : i;
+            if (onlyPos >= 0 && pos != onlyPos) continue;
+            if (syndrome == OFFSETS[i]) return pos;
+        }
+        return -1;
+    }
+
+    void receiveBit(int bit) {
+        reg = ((reg << 1) | (uint32_t)bit) & 0x3FFFFFF;
+        bitCount++;
+
+        if (!synced) {
+            // Two valid blocks a whole number of blocks apart, in sequence, give sync
+            int pos = matchOffset(reg);
+            if (pos < 0) return;
+            if (lastFound >= 0) {
+                long long dist = bitCount - lastFound;
+                if (dist % 26 == 0 && dist <= 26 * 8 && (lastFoundPos + dist / 26) % 4 == pos) {
+                    synced = true; badBlocks = 0;
+                    blockPos = pos; bitsToBlock = 26;
+                    std::fill(blockOk, blockOk + 4, false);
+                    storeBlock(pos, true);
+                    return;
+                }
+            }
+            lastFound = bitCount; lastFoundPos = pos;
+            return;
+        }
+
+        if (--bitsToBlock > 0) return;
+        bitsToBlock = 26;
+        blockPos = (blockPos + 1) % 4;
+        bool ok = matchOffset(reg, blockPos) >= 0;
+        badBlocks = ok ? std::max(0, badBlocks - 1) : badBlocks + 1;
+        if (badBlocks > 10) { synced = false; lastFound = -1; return; }
+        storeBlock(blockPos, ok);
+    }
+
+    void storeBlock(int pos, bool ok) {
+        blocks[pos] = (uint16_t)(reg >> 10);
+        blockOk[pos] = ok;
+        if (pos == 0 && ok) { info.pi = blocks[0]; info.hasPi = true; }
+        if (pos == 3) {
+            if (blockOk[1]) decodeGroup();
+            std::fill(blockOk, blockOk + 4, false);
+        }
+    }
+
+    static char rdsChar(uint16_t c) {
+        return (c >= 0x20 && c < 0x7F) ? (char)c : ' ';
+    }
+
+    void decodeGroup() {
+        uint16_t b = blocks[1], c = blocks[2], d = blocks[3];
+        int type = b >> 12;
+        bool versionB = (b >> 11) & 1;
+        info.pty = (b >> 5) & 0x1F;
+        info.groups++;
+
+        if (type == 0 && blockOk[3]) {
+            // Program Service name, 2 characters per group
+            int seg = b & 0x3;
+            char c0 = rdsChar(d >> 8), c1 = rdsChar(d & 0xFF);
+            // A changed segment after a complete name starts a new one
+            if (info.psComplete && (info.ps[seg * 2] != c0 || info.ps[seg * 2 + 1] != c1)) psMask = 0;
+            info.ps[seg * 2] = c0;
+            info.ps[seg * 2 + 1] = c1;
+            psMask |= 1u << seg;
+            info.psComplete = psMask == 0xF;
+        } else if (type == 2) {
+            // RadioText; the A/B flag toggling means a new text
+            int flag = (b >> 4) & 1;
+            if (flag != rtFlag) { std::memset(info.rt, ' ', 64); rtFlag = flag; rtMask = 0; rtSegments = 16; }
+            int seg = b & 0xF;
+            if (!versionB && blockOk[2] && blockOk[3]) {
+                uint16_t chars[4] = {(uint16_t)(c >> 8), (uint16_t)(c & 0xFF), (uint16_t)(d >> 8), (uint16_t)(d & 0xFF)};
+                setRadioText(seg, 4, chars);
+            } else if (versionB && blockOk[3]) {
+                uint16_t chars[2] = {(uint16_t)(d >> 8), (uint16_t)(d & 0xFF)};
+                setRadioText(seg, 2, chars);
+            }
+        } else if (type == 4 && !versionB && blockOk[2] && blockOk[3]) {
+            decodeClock(b, c, d);
+        }
+    }
+
+    void setRadioText(int seg, int n, const uint16_t* chars) {
+        int at = seg * n;
+        bool changed = false;
+        for (int i = 0; i < n; i++) {
+            // 0x0D ends the text: blank the rest
+            if (chars[i] == 0x0D) {
+                std::memset(info.rt + at + i, ' ', 64 - at - i);
+                rtSegments = seg + 1;
+                break;
+            }
+            changed |= info.rt[at + i] != rdsChar(chars[i]);
+            info.rt[at + i] = rdsChar(chars[i]);
+        }
+        // Stations that don't toggle the A/B flag: a changed segment after a complete text
+        if (info.rtComplete && changed) rtMask = 0;
+        rtMask |= 1u << seg;
+        unsigned all = (1u << rtSegments) - 1;
+        info.rtComplete = (rtMask & all) == all;
+    }
+
+    // Group 4A: Modified Julian Day + UTC + local offset (half hours)
+    void decodeClock(uint16_t b, uint16_t c, uint16_t d) {
+        long mjd = ((long)(b & 0x3) << 15) | (c >> 1);
+        int hour = ((c & 1) << 4) | (d >> 12);
+        int minute = (d >> 6) & 0x3F;
+        int offset = (d & 0x1F) * ((d & 0x20) ? -30 : 30); // minutes
+        if (hour > 23 || minute > 59) return;
+
+        int yp = (int)((mjd - 15078.2) / 365.25);
+        int mp = (int)((mjd - 14956.1 - (int)(yp * 365.25)) / 30.6001);
+        int day = (int)(mjd - 14956 - (int)(yp * 365.25) - (int)(mp * 30.6001));
+        int k = (mp == 14 || mp == 15) ? 1 : 0;
+        int year = yp + k + 1900, month = mp - 1 - k * 12;
+
+        int local = ((hour * 60 + minute + offset) % 1440 + 1440) % 1440;
+        // Fields wrapped to their widths, so -Wformat-truncation can see the text fits (MJD is 17 bits, it always does)
+        std::snprintf(info.ct, sizeof(info.ct), "%04u-%02u-%02u %02u:%02u", (unsigned)year % 10000u, (unsigned)month % 100u,
+                      (unsigned)day % 100u, (unsigned)local / 60u, (unsigned)local % 60u);
+    }
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free single-producer / single-consumer queue.
+// Slots are preallocated and reused, so items can be filled and consumed in place
+// (beginWrite/commitWrite, front/popFront) without reallocating their storage.
+template <typename T>
+class SpscQueue {
+private:
+    std::vector<T> slots;
+    size_t capacity;
+    alignas(64) std::atomic<size_t> head {0}; // next slot the producer writes
+    alignas(64) std::atomic<size_t> tail {0}; // next slot the consumer reads
+
+public:
+    SpscQueue(size_t size, const T& prototype = T()) : slots(size + 1, prototype), capacity(size + 1) {}
+
+    // --- Producer side ---
+    // Returns the slot to fill, or nullptr if the queue is full
+    T* beginWrite() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if ((h + 1) % capacity == tail.load(std::memory_order_acquire)) return nullptr;
+        return &slots[h];
+    }
+
+    void commitWrite() {
+        head.store((head.load(std::memory_order_relaxed) + 1) % capacity, std::memory_order_release);
+    }
+
+    bool push(const T& item) {
+        T* slot = beginWrite();
+        if (!slot) return false;
+        *slot = item;
+        commitWrite();
+        return true;
+    }
+
+    // --- Consumer side ---
+    // Returns the oldest item, or nullptr if the queue is empty
+    T* front() {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return nullptr;
+        return &slots[t];
+    }
+
+    void popFront() {
+        tail.store((tail.load(std::memory_order_relaxed) + 1) % capacity, std::memory_order_release);
+    }
+
+    bool pop(T& out) {
+        T* item = front();
+        if (!item) return false;
+        out = *item;
+        popFront();
+        return true;
+    }
+
+    size_t available() const {
+        size_t h = head.load(std::memory_order_acquire);
+        size_t t = tail.load(std::memory_order_acquire);
+        return (h + capacity - t) % capacity;
+    }
+};
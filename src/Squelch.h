@@ -0,0 +1,213 @@
+#pragma once
+
+#include "FilterDesign.h"
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <bitset>
+
+// Squelch settings. The carrier squelch compares the channel power with thresholdDb
+// (dBFS); a CTCSS tone or DCS code additionally has to be present when one is set.
+struct SquelchSettings {
+    bool enabled = false;
+    float thresholdDb = -60.0f;
+    float hysteresisDb = 3.0f;  // closes this much below the threshold
+    float tailMs = 150.0f;      // stays open this long after the signal drops
+    float ctcssHz = 0.0f;       // 0: no tone required
+    int dcsCode = 0;            // octal code (e.g. 023), 0: no code required
+
+    bool operator==(const SquelchSettings& o) const {
+        return enabled == o.enabled && thresholdDb == o.thresholdDb && hysteresisDb == o.hysteresisDb
+            && tailMs == o.tailMs && ctcssHz == o.ctcssHz && dcsCode == o.dcsCode;
+    }
+};
+
+// Sub-audible signalling decoder for NFM audio. The band below 300 Hz is low-passed and
+// decimated to ~2 kHz, where
+//  - CTCSS: a Goertzel filter per standard tone runs over Hann-windowed 0.3 s blocks; the
+//    strongest one counts when it holds most of the sub-audio energy,
+//  - DCS: 134.4 bit/s NRZ with a zero-crossing bit clock; a 23-bit word is accepted when it
+//    is a Golay (23,12) codeword with the 100 marker bits, either polarity and bit order.
+class ToneDecoder {
+public:
+    static constexpr int NUM_TONES = 50;
+    static constexpr float CTCSS_TONES[NUM_TONES] = {
+        67.0f, 69.3f, 71.9f, 74.4f, 77.0f, 79.7f, 82.5f, 85.4f, 88.5f, 91.5f,
+        94.8f, 97.4f, 100.0f, 103.5f, 107.2f, 110.9f, 114.8f, 118.8f, 123.0f, 127.3f,
+        131.8f, 136.5f, 141.3f, 146.2f, 151.4f, 156.7f, 159.8f, 162.2f, 165.5f, 167.9f,
+        171.3f, 173.8f, 177.3f, 179.9f, 183.5f, 186.2f, 189.9f, 192.8f, 196.6f, 199.5f,
+        203.5f, 206.5f, 210.7f, 218.1f, 225.7f, 229.1f, 233.6f, 241.8f, 250.3f, 254.1f};
+
+    float ctcssHz = 0.0f; // detected tone, 0 if none
+    int dcsCode = 0;      // detected code (lowest alias), 0 if none
+
+    void reset() {
+        ctcssHz = 0.0f; dcsCode = 0;
+        decimCount = 0; blockPos = 0; energy = 0.0;
+        std::fill(s1, s1 + NUM_TONES, 0.0); std::fill(s2, s2 + NUM_TONES, 0.0);
+        lp1.reset(); lp2.reset();
+        dcsReg = 0; dcsBits = 0; dcsSeen = 0; dcsMiss = 0;
+        wordCodes.reset(); lastWordCodes.reset();
+    }
+
+    // True if the code (or the word it's sent as) was seen within the last two words
+    bool dcsMatches(int code) const {
+        return code > 0 && code < 512 && (wordCodes[code] || lastWordCodes[code]);
+    }
+
+    void process(const float* audio, size_t count, double sampleRate) {
+        if (sampleRate != rate) setRate(sampleRate);
+        for (size_t i = 0; i < count; i++) {
+            float x = lp2.process(lp1.process(audio[i]));
+            if (++decimCount < decimation) continue;
+            decimCount = 0;
+            ctcssSample(x);
+            dcsSample(x);
+        }
+    }
+
+private:
+    double rate = 0.0, lowRate = 2000.0;
+    int decimation = 1, decimCount = 0;
+    Biquad lp1, lp2; // 4th order Butterworth at 300 Hz
+
+    // CTCSS
+    int blockLen = 600, blockPos = 0;
+    double coeff[NUM_TONES] = {};
+    double s1[NUM_TONES] = {}, s2[NUM_TONES] = {};
+    double energy = 0.0;
+
+    // DCS
+    double bitStep = 0.0, bitPhase = 0.0;
+    float lastX = 0.0f;
+    uint32_t dcsReg = 0;
+    int dcsBits = 0, dcsSeen = 0, dcsMiss = 0;
+    std::bitset<512> wordCodes, lastWordCodes; // every alias decoded in the current / last word
+
+    void setRate(double sampleRate) {
+        rate = sampleRate;
+        decimation = std::max(1, (int)std::lround(rate / 2000.0));
+        lowRate = rate / decimation;
+        lp1 = Biquad::lowpass(300.0 / rate, 0.5412);
+        lp2 = Biquad::lowpass(300.0 / rate, 1.3066);
+        blockLen = (int)(0.3 * lowRate);
+        for (int k = 0; k < NUM_TONES; k++) coeff[k] = 2.0 * std::cos(2.0 * PI * CTCSS_TONES[k] / lowRate);
+        bitStep = 134.4 / lowRate;
+        reset();
+    }
+
+    void ctcssSample(float x) {
+        double w = 0.5 - 0.5 * std::cos(2.0 * PI * blockPos / (blockLen - 1));
+        double xw = x * w;
+        energy += xw * x * w;
+        for (int k = 0; k < NUM_TONES; k++) {
+            double s0 = xw + coeff[k] * s1[k] - s2[k];
+            s2[k] = s1[k]; s1[k] = s0;
+        }
+        if (++blockPos < blockLen) return;
+
+        // A pure windowed tone gives power / (energy * N) = 1/3
+        int best = -1; double bestPower = 0.0;
+        for (int k = 0; k < NUM_TONES; k++) {
+            double power = s1[k] * s1[k] + s2[k] * s2[k] - coeff[k] * s1[k] * s2[k];
+            if (power > bestPower) { bestPower = power; best = k; }
+        }
+        bool found = best >= 0 && energy > 1e-12 && bestPower / (energy * blockLen) > 0.1;
+        ctcssHz = found ? CTCSS_TONES[best] : 0.0f;
+
+        blockPos = 0; energy = 0.0;
+        std::fill(s1, s1 + NUM_TONES, 0.0); std::fill(s2, s2 + NUM_TONES, 0.0);
+    }
+
+    void dcsSample(float x) {
+        // Bit clock: zero crossings pull the bit boundary (phase 0) towards them
+        if ((x >= 0.0f) != (lastX >= 0.0f)) {
+            double err = bitPhase > 0.5 ? bitPhase - 1.0 : bitPhase;
+            bitPhase -= 0.2 * err;
+        }
+        lastX = x;
+        double before = bitPhase;
+        bitPhase += bitStep;
+        if (bitPhase >= 1.0) bitPhase -= 1.0;
+        if (!(before < 0.5 && bitPhase >= 0.5)) return; // sample mid-bit
+
+        dcsReg = ((dcsReg << 1) | (x > 0.0f ? 1u : 0u)) & 0x7FFFFF;
+        int code = decodeDcs(dcsReg);
+        if (code > 0) {
+            wordCodes[code] = true;
+            if (dcsSeen == 0 || code < dcsSeen) dcsSeen = code;
+        }
+
+        // Word boundary (every 23 bits): publish the lowest code seen in this word
+        if (++dcsBits < 23) return;
+        dcsBits = 0;
+        lastWordCodes = wordCodes;
+        wordCodes.reset();
+        if (dcsSeen > 0) { dcsCode = dcsSeen; dcsMiss = 0; }
+        else if (++dcsMiss >= 3) dcsCode = 0;
+        dcsSeen = 0;
+    }
+
+    static uint32_t golayRemainder(uint32_t w) {
+        for (int i = 22; i >= 11; i--) if (w & (1u << i)) w ^= 0xC75u << (i - 11);
+        return w & 0x7FF;
+    }
+
+    static uint32_t reverse23(uint32_t w) {
+        uint32_t r = 0;
+        for (int i = 0; i < 23; i++) if (w & (1u << i)) r |= 1u << (22 - i);
+        return r;
+    }
+
+    // Octal code of a DCS word: 12 data bits (100 marker + 9 code bits) above 11 parity bits
+    static int decodeDcs(uint32_t reg) {
+        uint32_t variants[4] = {reg, ~reg & 0x7FFFFF, reverse23(reg), reverse23(~reg & 0x7FFFFF)};
+        for (uint32_t w : variants) {
+            if (golayRemainder(w) != 0) continue;
+            uint32_t data = w >> 11;
+            if ((data >> 9) == 0x4 && (data & 0x1FF) != 0) return (int)(data & 0x1FF);
+        }
+        return 0;
+    }
+};
+
+// Carrier squelch with hysteresis and tail, optionally qualified by CTCSS / DCS. Decided once
+// per block; while closed the demodulator outputs silence and the VFO skips mixing and recording.
+class Squelch {
+public:
+    SquelchSettings settings;
+    ToneDecoder tones;
+    bool open = true;
+    float powerDb = -150.0f;
+
+    void reset() { open = !settings.enabled; carrier = false; tailLeft = 0.0f; tones.reset(); }
+
+    bool toneRequired() const { return settings.ctcssHz > 0.0f || settings.dcsCode > 0; }
+
+    // meanPower: channel power of the block (|IQ|^2). audio: detector output before AGC,
+    // scanned for CTCSS / DCS when decodeTones is set (NFM).
+    bool update(double meanPower, const float* audio, size_t count, double audioRate, bool decodeTones) {
+        powerDb = (float)(10.0 * std::log10(meanPower + 1e-20));
+        if (decodeTones) tones.process(audio, count, audioRate);
+        if (!settings.enabled) { open = true; return open; }
+
+        float blockMs = (float)(1000.0 * count / audioRate);
+        if (powerDb > settings.thresholdDb) {
+            carrier = true;
+            tailLeft = settings.tailMs;
+        } else if (carrier && powerDb < settings.thresholdDb - settings.hysteresisDb) {
+            tailLeft -= blockMs;
+            if (tailLeft <= 0.0f) carrier = false;
+        }
+
+        bool toneOk = true;
+        if (settings.ctcssHz > 0.0f) toneOk = std::fabs(tones.ctcssHz - settings.ctcssHz) < 1.0f;
+        if (settings.dcsCode > 0) toneOk = toneOk && tones.dcsMatches(settings.dcsCode);
+        open = carrier && toneOk;
+        return open;
+    }
+
+private:
+    bool carrier = false;
+    float tailLeft = 0.0f;
+};
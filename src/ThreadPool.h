@@ -0,0 +1,170 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+
+// Counts the unfinished tasks submitted to it; ThreadPool::wait() returns once it is zero
+class TaskGroup {
+    friend class ThreadPool;
+    std::atomic<size_t> pending {0};
+
+public:
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// Work-stealing scheduler for the DSP stages of a block.
+// Every worker owns a deque: its own tasks are pushed and popped at the back (newest first,
+// data still in cache), an idle worker steals from the front of the others (oldest first,
+// usually the biggest piece left). Other threads (the DSP thread) hand their tasks out
+// round-robin and, in wait(), run tasks themselves instead of sleeping. Tasks may submit
+// and wait for tasks of their own (the VFO fan-out inside a demod task).
+// A task is a function pointer + context + index in a fixed ring, so submitting does not
+// allocate; the callable must outlive the wait() for its group.
+// Which thread runs what is not deterministic; results go to slots owned by the task and
+// are consumed after wait() in stream order, so the output is.
+class ThreadPool {
+private:
+    struct Task {
+        void (*fn)(void*, size_t) = nullptr;
+        void* ctx = nullptr;
+        size_t index = 0;
+        TaskGroup* group = nullptr;
+    };
+
+    // Ring of tasks behind a lock held for a few instructions (the owner plus the odd thief)
+    struct Deque {
+        static constexpr size_t CAPACITY = 1024;
+        std::mutex mtx;
+        Task ring[CAPACITY];
+        size_t head = 0, tail = 0; // [head, tail), modulo CAPACITY
+
+        bool pushBack(const Task& t) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (tail - head == CAPACITY) return false;
+            ring[tail++ % CAPACITY] = t;
+            return true;
+        }
+        bool popBack(Task& t) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (tail == head) return false;
+            t = ring[--tail % CAPACITY];
+            return true;
+        }
+        bool popFront(Task& t) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (tail == head) return false;
+            t = ring[head++ % CAPACITY];
+            return true;
+        }
+    };
+
+    std::vector<std::unique_ptr<Deque>> deques; // one per worker
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued {0};     // tasks sitting in the deques
+    std::atomic<size_t> nextDeque {0};  // round-robin for submissions from outside
+    std::mutex sleepMtx;
+    std::condition_variable sleepCv;    // new task, group finished or stopping
+    bool stopping = false;
+
+    static inline thread_local const ThreadPool* currentPool = nullptr;
+    static inline thread_local int workerIndex = -1;
+
+    int self() const { return currentPool == this ? workerIndex : -1; }
+
+    void execute(const Task& t) {
+        t.fn(t.ctx, t.index);
+        if (t.group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(sleepMtx);
+            sleepCv.notify_all();
+        }
+    }
+
+    // Own deque first, then steal; false when every deque was empty
+    bool runOne(int me) {
+        Task t;
+        if (me >= 0 && deques[me]->popBack(t)) { queued--; execute(t); return true; }
+        const size_t n = deques.size();
+        size_t start = me >= 0 ? (size_t)me + 1 : nextDeque.load(std::memory_order_relaxed);
+        for (size_t k = 0; k < n; k++) {
+            size_t d = (start + k) % n;
+            if ((int)d == me) continue;
+            if (deques[d]->popFront(t)) { queued--; execute(t); return true; }
+        }
+        return false;
+    }
+
+    void spawn(TaskGroup& group, void (*fn)(void*, size_t), void* ctx, size_t index) {
+        group.pending.fetch_add(1, std::memory_order_relaxed);
+        Task t{fn, ctx, index, &group};
+        if (deques.empty()) { execute(t); return; }
+
+        int me = self();
+        size_t d = me >= 0 ? (size_t)me : nextDeque.fetch_add(1, std::memory_order_relaxed) % deques.size();
+        queued++;
+        if (!deques[d]->pushBack(t)) { queued--; execute(t); return; } // full: run it here
+        { std::lock_guard<std::mutex> lock(sleepMtx); }
+        sleepCv.notify_one();
+    }
+
+    void workerLoop(int index) {
+        currentPool = this;
+        workerIndex = index;
+        while (true) {
+            if (runOne(index)) continue;
+            std::unique_lock<std::mutex> lock(sleepMtx);
+            sleepCv.wait(lock, [&] { return stopping || queued.load() > 0; });
+            if (stopping && queued.load() == 0) return;
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()) - 1) {
+        for (size_t i = 0; i < threads; i++) deques.push_back(std::make_unique<Deque>());
+        for (size_t i = 0; i < threads; i++) workers.emplace_back([this, i] { workerLoop((int)i); });
+    }
+
+    ~ThreadPool() {
+        { std::lock_guard<std::mutex> lock(sleepMtx); stopping = true; }
+        sleepCv.notify_all();
+        for (auto& w : workers) if (w.joinable()) w.join();
+    }
+
+    size_t size() const { return workers.size() + 1; } // workers + calling thread
+
+    // Queues fn() in group; fn must stay alive until wait(group) returns
+    template <typename F>
+    void submit(TaskGroup& group, F& fn) {
+        spawn(group, [](void* ctx, size_t) { (*static_cast<F*>(ctx))(); }, (void*)&fn, 0);
+    }
+
+    // Runs queued tasks until every task of group is done
+    void wait(TaskGroup& group) {
+        int me = self();
+        while (!group.done()) {
+            if (runOne(me)) continue;
+            std::unique_lock<std::mutex> lock(sleepMtx);
+            sleepCv.wait(lock, [&] { return group.done() || queued.load() > 0; });
+        }
+    }
+
+    // Runs fn(i) for i in [0, n) and returns when all are done. May be called from any
+    // thread, tasks included.
+    template <typename F>
+    void parallelFor(size_t n, F&& fn) {
+        if (n == 0) return;
+        if (n == 1 || workers.empty()) { for (size_t i = 0; i < n; i++) fn(i); return; }
+
+        TaskGroup group;
+        auto thunk = [](void* ctx, size_t i) { (*static_cast<std::remove_reference_t<F>*>(ctx))(i); };
+        // The caller takes index 0 itself, the rest is spread over the deques
+        for (size_t i = 1; i < n; i++) spawn(group, thunk, (void*)&fn, i);
+        fn(0);
+        wait(group);
+    }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer triple buffer.
+// The producer fills writeBuffer() in place and calls publish(); the consumer calls
+// update() and reads readBuffer(). Neither side ever blocks or waits for the other,
+// and the three slots are reused forever, so T's storage (e.g. vector capacity) is
+// allocated once and never reallocated as long as its size does not grow.
+template <typename T>
+class TripleBuffer {
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t DIRTY = 0x4; // set while the middle slot holds data the reader hasn't taken
+
+    T slots[3];
+    std::atomic<uint8_t> middle {1};
+    uint8_t back = 0;  // producer-owned
+    uint8_t front = 2; // consumer-owned
+
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& initial) : slots{initial, initial, initial} {}
+
+    // --- Producer side ---
+    T& writeBuffer() { return slots[back]; }
+
+    void publish() {
+        back = middle.exchange(back | DIRTY, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // --- Consumer side ---
+    // Returns true if a newer value was published since the last call
+    bool update() {
+        if (!(middle.load(std::memory_order_relaxed) & DIRTY)) return false;
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    const T& readBuffer() const { return slots[front]; }
+};
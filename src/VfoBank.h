@@ -0,0 +1,253 @@
+#pragma once
+
+#include "Demodulator.h"
+#include "AudioSink.h"
+#include "WavWriter.h"
+#include "ThreadPool.h"
+#include <vector>
+#include <map>
+#include <memory>
+#include <string>
+#include <algorithm>
+
+// Settings of one receive channel (VFO). The frequency is absolute, so a VFO stays on its
+// channel when the center frequency moves.
+struct VfoSettings {
+    int id = 0;
+    long long freqHz = 0;
+    double bandwidthHz = 12000.0;
+    Mode mode = Mode::NFM;
+    float volume = 1.0f;
+    int outputDevice = -1; // -1: mixed into the main output, otherwise index of a playback device
+    bool stereo = true;           // WFM stereo decoding
+    float deemphasisUs = 50.0f;   // WFM de-emphasis
+    double passbandLowHz = Demodulator::SSB_LOW_CUT_HZ; // SSB passband [low, low + bandwidth]
+    double cwPitchHz = Demodulator::CW_PITCH_HZ;
+    SamSideband samSideband = SamSideband::DSB;
+    AgcSettings agc;
+    SquelchSettings squelch;
+    NoiseBlankerSettings noiseBlanker;
+    NoiseReductionSettings noiseReduction;
+    AutoNotchSettings autoNotch;
+    DiscriminatorType discriminator = DiscriminatorType::Polynomial; // NFM / WFM
+
+    bool operator==(const VfoSettings& o) const {
+        return id == o.id && freqHz == o.freqHz && bandwidthHz == o.bandwidthHz && mode == o.mode
+            && volume == o.volume && outputDevice == o.outputDevice
+            && stereo == o.stereo && deemphasisUs == o.deemphasisUs
+            && passbandLowHz == o.passbandLowHz && cwPitchHz == o.cwPitchHz
+            && samSideband == o.samSideband && agc == o.agc && squelch == o.squelch
+            && noiseBlanker == o.noiseBlanker && noiseReduction == o.noiseReduction
+            && autoNotch == o.autoNotch && discriminator == o.discriminator;
+    }
+};
+
+// Demodulates any number of VFOs from one shared IQ stream. The VFOs of a block run in
+// parallel on the thread pool; their audio is mixed into the main output or routed to a
+// playback device of their own, and each VFO records to its own file. Blocks with a closed
+// squelch are neither mixed nor recorded.
+class VfoBank {
+public:
+    struct Vfo {
+        VfoSettings settings;
+        Demodulator demod;
+        WavWriter recorder;
+        bool recordStereo = false;
+        std::vector<float> audio, audioRight;
+        std::vector<float> interleaved; // stereo recording
+        size_t audioCount = 0;
+
+        Vfo(const VfoSettings& s, double srIn, double srOut) : settings(s), demod(srIn, srOut) {}
+    };
+
+private:
+    struct DeviceOutput {
+        std::unique_ptr<AudioSink> sink;
+        std::vector<float> mix, mixRight;
+    };
+
+    ThreadPool& pool;
+    double sampleRateIn = 0.0;
+    double sampleRateOut;
+    std::vector<std::unique_ptr<Vfo>> vfos;
+    std::map<int, DeviceOutput> deviceOutputs; // by playback device index
+    uint64_t samplesConsumed = 0;              // keeps the decimation phase of all VFOs aligned
+    size_t blockCapacity = 0;
+
+    bool recording = false;
+    std::string recPrefix;
+
+    std::string recordingName(const Vfo& v) const {
+        std::string name = recPrefix + "_" + std::to_string(v.settings.freqHz / 1000) + "kHz";
+        if (v.settings.id != 0) name += "_vfo" + std::to_string(v.settings.id);
+        return name + "_audio.wav";
+    }
+
+    void startRecorder(Vfo& v) {
+        // WFM stereo is recorded as a stereo file, everything else as mono
+        v.recordStereo = v.settings.mode == Mode::WFM && v.settings.stereo;
+        v.recorder.start(recordingName(v), (uint32_t)sampleRateOut, v.recordStereo ? 2 : 1);
+    }
+
+    void resizeBuffers(Vfo& v) {
+        size_t n = v.demod.maxOutput(blockCapacity);
+        v.audio.resize(n); v.audioRight.resize(n); v.interleaved.resize(2 * n);
+    }
+
+    void configure(Vfo& v, long long centerHz) {
+        const VfoSettings& s = v.settings;
+        double offset = (double)(s.freqHz - centerHz);
+        // Outside the received span the VFO is kept silent, but still keeps its output rate
+        bool inSpan = std::abs(offset + Demodulator::passbandCenter(s.mode, s.bandwidthHz, s.passbandLowHz)) < sampleRateIn / 2.0;
+        v.demod.configure(offset, s.bandwidthHz, inSpan ? s.mode : Mode::OFF, s.volume);
+        v.demod.setFmOptions(s.stereo, s.deemphasisUs);
+        v.demod.setSsbOptions(s.passbandLowHz, s.cwPitchHz);
+        v.demod.setSamSideband(s.samSideband);
+        v.demod.setDiscriminator(s.discriminator);
+        v.demod.setAgc(s.agc);
+        v.demod.setNoiseBlanker(s.noiseBlanker);
+        v.demod.setNoiseReduction(s.noiseReduction);
+        v.demod.setAutoNotch(s.autoNotch);
+        v.demod.setSquelch(s.squelch);
+    }
+
+public:
+    VfoBank(ThreadPool& p, double srOut) : pool(p), sampleRateOut(srOut) {}
+
+    ~VfoBank() { stopRecording(); }
+
+    size_t size() const { return vfos.size(); }
+
+    // Upper bound of (mixed) output samples for `inCount` input samples
+    size_t maxOutput(size_t inCount) const {
+        int decimation = std::max(1, (int)(sampleRateIn / sampleRateOut));
+        return inCount / decimation + 1;
+    }
+
+    // Applies the VFO list for the next block: VFOs are matched by id, new ones are created
+    // in phase with the others, missing ones are closed
+    void sync(const std::vector<VfoSettings>& list, long long centerHz, double sampleRate) {
+        if (sampleRate != sampleRateIn) {
+            sampleRateIn = sampleRate;
+            samplesConsumed = 0;
+            // The decimation changed, so do the output sizes of a block
+            for (auto& v : vfos) { v->demod = Demodulator(sampleRateIn, sampleRateOut); resizeBuffers(*v); }
+            for (auto& d : deviceOutputs) {
+                d.second.mix.resize(maxOutput(blockCapacity));
+                d.second.mixRight.resize(maxOutput(blockCapacity));
+            }
+        }
+
+        // Remove VFOs that are gone
+        vfos.erase(std::remove_if(vfos.begin(), vfos.end(), [&](const std::unique_ptr<Vfo>& v) {
+            bool keep = std::any_of(list.begin(), list.end(), [&](const VfoSettings& s) { return s.id == v->settings.id; });
+            if (!keep) v->recorder.stop();
+            return !keep;
+        }), vfos.end());
+
+        // Update existing, add new ones, keep the list order
+        for (size_t i = 0; i < list.size(); i++) {
+            auto it = std::find_if(vfos.begin() + i, vfos.end(), [&](const std::unique_ptr<Vfo>& v) { return v->settings.id == list[i].id; });
+            if (it == vfos.end()) {
+                auto v = std::make_unique<Vfo>(list[i], sampleRateIn, sampleRateOut);
+                v->demod.alignDecimation(samplesConsumed);
+                resizeBuffers(*v);
+                if (recording) startRecorder(*v);
+                it = vfos.insert(vfos.begin() + i, std::move(v));
+            } else if (it != vfos.begin() + i) {
+                std::iter_swap(vfos.begin() + i, it);
+                it = vfos.begin() + i;
+            }
+            (*it)->settings = list[i];
+            configure(**it, centerHz);
+        }
+
+        // Open playback devices that VFOs are routed to, close unused ones
+        for (auto it = deviceOutputs.begin(); it != deviceOutputs.end();) {
+            bool used = std::any_of(list.begin(), list.end(), [&](const VfoSettings& s) { return s.outputDevice == it->first; });
+            it = used ? std::next(it) : deviceOutputs.erase(it);
+        }
+        for (const VfoSettings& s : list) {
+            if (s.outputDevice < 0 || deviceOutputs.count(s.outputDevice)) continue;
+            DeviceOutput& out = deviceOutputs[s.outputDevice];
+            out.sink = std::make_unique<AudioSink>();
+            if (out.sink->initDevice(s.outputDevice, (int)sampleRateOut)) out.sink->start();
+            out.mix.resize(maxOutput(blockCapacity));
+            out.mixRight.resize(maxOutput(blockCapacity));
+        }
+    }
+
+    const Vfo* find(int id) const {
+        for (auto& v : vfos) if (v->settings.id == id) return v.get();
+        return nullptr;
+    }
+
+    // Demodulates one block for every VFO. Audio of VFOs without an own device is mixed into
+    // mixLeft / mixRight (size them with maxOutput()); returns the number of frames written there.
+    size_t process(const Complex* iq, size_t count, float* mixLeft, float* mixRight, size_t mixCapacity) {
+        if (count > blockCapacity) {
+            blockCapacity = count;
+            for (auto& v : vfos) resizeBuffers(*v);
+            for (auto& d : deviceOutputs) {
+                d.second.mix.resize(maxOutput(blockCapacity));
+                d.second.mixRight.resize(maxOutput(blockCapacity));
+            }
+        }
+
+        pool.parallelFor(vfos.size(), [&](size_t i) {
+            Vfo& v = *vfos[i];
+            v.audioCount = v.demod.process(iq, count, v.audio.data(), v.audio.size(), v.audioRight.data());
+            if (!v.recorder.active || !v.demod.squelchOpen()) return;
+            if (!v.recordStereo) { v.recorder.write(v.audio.data(), v.audioCount); return; }
+            for (size_t j = 0; j < v.audioCount; j++) { v.interleaved[2 * j] = v.audio[j]; v.interleaved[2 * j + 1] = v.audioRight[j]; }
+            v.recorder.write(v.interleaved.data(), 2 * v.audioCount);
+        });
+        samplesConsumed += count;
+
+        // All VFOs share the decimation phase, so they produced the same number of samples
+        size_t n = vfos.empty() ? 0 : std::min(vfos[0]->audioCount, mixCapacity);
+        std::fill(mixLeft, mixLeft + n, 0.0f);
+        std::fill(mixRight, mixRight + n, 0.0f);
+        for (auto& d : deviceOutputs) {
+            std::fill(d.second.mix.begin(), d.second.mix.begin() + n, 0.0f);
+            std::fill(d.second.mixRight.begin(), d.second.mixRight.begin() + n, 0.0f);
+        }
+
+        for (auto& v : vfos) {
+            if (!v->demod.squelchOpen()) continue;
+            float* dstL = mixLeft;
+            float* dstR = mixRight;
+            if (v->settings.outputDevice >= 0) {
+                DeviceOutput& d = deviceOutputs[v->settings.outputDevice];
+                dstL = d.mix.data(); dstR = d.mixRight.data();
+            }
+            for (size_t i = 0; i < n; i++) { dstL[i] += v->audio[i]; dstR[i] += v->audioRight[i]; }
+        }
+        for (size_t i = 0; i < n; i++) {
+            mixLeft[i] = std::clamp(mixLeft[i], -1.0f, 1.0f);
+            mixRight[i] = std::clamp(mixRight[i], -1.0f, 1.0f);
+        }
+        for (auto& d : deviceOutputs) {
+            for (size_t i = 0; i < n; i++) {
+                d.second.mix[i] = std::clamp(d.second.mix[i], -1.0f, 1.0f);
+                d.second.mixRight[i] = std::clamp(d.second.mixRight[i], -1.0f, 1.0f);
+            }
+            d.second.sink->pushStereo(d.second.mix.data(), d.second.mixRight.data(), n);
+        }
+        return n;
+    }
+
+    // Starts one audio recording per VFO, named prefix_<freq>kHz[_vfo<id>]_audio.wav.
+    // Returns the file name of the first VFO.
+    std::string startRecording(const std::string& prefix) {
+        recording = true;
+        recPrefix = prefix;
+        for (auto& v : vfos) startRecorder(*v);
+        return vfos.empty() ? recPrefix : recordingName(*vfos[0]);
+    }
+
+    void stopRecording() {
+        recording = false;
+        for (auto& v : vfos) v->recorder.stop();
+    }
+};
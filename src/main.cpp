@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <fstream>
 #include <ctime>
+#include <cstring>
 
 #include "DSP.h"
 #include "AudioSink.h"
@@ -18,6 +19,13 @@
 #include "UI.h"
 #include "NativeDialogs.h"
 #include "IQSources.h"
+#include "TripleBuffer.h"
+#include "SpscQueue.h"
+#include "WavWriter.h"
+#include "ThreadPool.h"
+#include "VfoBank.h"
+#include "Pipeline.h"
+#include "PipelineNodes.h"
 
 const int W_WIDTH = 1200, W_HEIGHT = 800;
 const int SPEC_W = 900, SPEC_H = 250;
@@ -25,108 +33,109 @@ const int WATERFALL_H = 400;
 const int FFT_SIZE = 1024;
 const double AUDIO_RATE = 48000.0;
 const int TOP_BAR_H = 60; 
+const size_t WATERFALL_QUEUE_ROWS = 512;
 
 const std::vector<uint32_t> RTL_RATES_VAL = {1024000, 1400000, 1800000, 2048000, 2400000, 3200000};
 const std::vector<uint32_t> SDRPLAY_RATES_VAL = {2000000, 4000000, 6000000, 8000000, 10000000};
 
-// --- WAV WRITER HELPER ---
-struct WavWriter {
-    std::ofstream file;
-    uint32_t dataSize = 0;
-    uint32_t sampleRate = 0;
-    uint16_t channels = 0;
-    bool active = false;
-
-    void start(std::string path, uint32_t sr, uint16_t ch, bool isFloat = true) {
-        if (active) stop();
-        file.open(path, std::ios::binary);
-        if (!file.is_open()) { std::cerr << "Failed to create file: " << path << "\n"; return; }
-        
-        sampleRate = sr;
-        channels = ch;
-        dataSize = 0;
-        active = true;
-
-        // Placeholder Header
-        char header[44] = {0};
-        file.write(header, 44);
-    }
+enum class RecMode { AUDIO, BASEBAND, CHANNELS }; // CHANNELS: narrowband IQ of the channel under each VFO
 
-    void write(const float* data, size_t count) {
-        if (!active) return;
-        // Convert float (-1..1) to int16 for compatibility
-        for(size_t i=0; i<count; i++) {
-            float s = std::clamp(data[i], -1.0f, 1.0f);
-            int16_t val = static_cast<int16_t>(s * 32767.0f);
-            file.write((char*)&val, sizeof(int16_t));
-        }
-        dataSize += count * sizeof(int16_t);
-    }
+// Latest smoothed spectrum trace (only the newest one matters to the UI)
+struct SpectrumFrame {
+    std::vector<double> spectrum;
 
-    void stop() {
-        if (!active || !file.is_open()) return;
-        
-        // Fill Header
-        file.seekp(0);
-        uint32_t fileSize = dataSize + 36;
-        uint32_t byteRate = sampleRate * channels * 2; // 16-bit
-        uint16_t blockAlign = channels * 2;
-        
-        file.write("RIFF", 4);
-        file.write((char*)&fileSize, 4);
-        file.write("WAVE", 4);
-        file.write("fmt ", 4);
-        uint32_t subchunk1Size = 16;
-        uint16_t audioFormat = 1; // PCM
-        uint16_t bitsPerSample = 16;
-        
-        file.write((char*)&subchunk1Size, 4);
-        file.write((char*)&audioFormat, 2);
-        file.write((char*)&channels, 2);
-        file.write((char*)&sampleRate, 4);
-        file.write((char*)&byteRate, 4);
-        file.write((char*)&blockAlign, 2);
-        file.write((char*)&bitsPerSample, 2);
-        file.write("data", 4);
-        file.write((char*)&dataSize, 4);
-
-        file.close();
-        active = false;
-    }
+    SpectrumFrame() : spectrum(FFT_SIZE, -100.0) {}
+};
+
+// Receiver state of the main VFO, for indicators (only the newest one matters to the UI)
+struct ReceiverStatus {
+    bool stereo = false; // WFM pilot locked
+    RdsInfo rds;         // WFM only, cleared otherwise
+    bool squelchOpen = true;
+    float powerDb = -150.0f;  // channel power (dBFS)
+    float ctcssHz = 0.0f;     // detected CTCSS tone / DCS code (NFM), 0 if none
+    int dcsCode = 0;
 };
 
-enum class RecMode { AUDIO, BASEBAND };
+// One colored waterfall line, stamped with the stream time (seconds of consumed samples) it was taken at
+struct WaterfallRow {
+    std::vector<uint8_t> pixels;
+    double timestamp = 0.0;
 
-struct SharedData {
-    std::mutex mtx;
+    WaterfallRow() : pixels(SPEC_W * 4, 0) {}
+};
+
+const float SQUELCH_OFF_DB = -120.0f;
+
+// Control state owned by the UI thread. It is published as an immutable, versioned
+// snapshot: the DSP thread reads it wait-free and only reacts when the version changes.
+struct ControlParams {
+    uint64_t version = 0;
     double tunedFreqPercent = 0.5;
     double bandwidth = 12000.0;
     long long centerFreq = 0;
     
     float volume = 1.0f;
     bool isMuted = false;
-    float rfGain = -1.0f;    // -1.0 is AUTO, 0..50 manual
     
-    Mode mode = Mode::NFM;
     bool isPlaying = false;
     float minDb = -120.0f;
     float maxDb = 0.0f;
-    
-    std::vector<double> fftSpectrum;
-    std::vector<uint8_t> waterfallRow;
-    bool newWaterfallData = false;
-    
-    std::string currentFilename = "None";
-    float mouseX_spectrum = -1.0f; 
-    float mouseY_spectrum = -1.0f;
+    float waterfallRate = 60.0f; // rows per second of stream time
+    std::vector<VfoSettings> extraVfos; // VFOs besides the main one
+    bool stereo = true;                 // WFM stereo decoding
+    float deemphasisUs = 50.0f;         // WFM de-emphasis
+    bool audioAgc = true;               // demodulator AGC (not the tuner's RF AGC)
+    SamSideband samSideband = SamSideband::DSB;
+    float squelchDb = SQUELCH_OFF_DB;   // carrier squelch threshold, off at the slider minimum
+    float ctcssHz = 0.0f;               // tone squelch (0: none)
+    int dcsCode = 0;
+    bool noiseBlanker = false;          // impulse blanker on the raw IQ
+    float noiseReduction = 0.0f;        // audio noise reduction strength, 0: off
+    bool autoNotch = false;             // carrier notches (AM / SSB)
+    DiscriminatorType discriminator = DiscriminatorType::Polynomial; // FM detector, accuracy vs speed
 
     // Pola Nagrywania
-    bool isRecording = false;
+    bool isRecording = false; // state, not a command, so a full queue can never lose it
     RecMode recMode = RecMode::AUDIO;
     std::string recPath = ""; 
-    std::string recStatus = "Idle"; // Do wyświetlania nazwy pliku
 
-    SharedData() : fftSpectrum(FFT_SIZE, -100.0), waterfallRow(SPEC_W * 4, 0) {}
+    // Everything except the version
+    bool sameSettings(const ControlParams& o) const {
+        return tunedFreqPercent == o.tunedFreqPercent && bandwidth == o.bandwidth && centerFreq == o.centerFreq
+            && volume == o.volume && isMuted == o.isMuted
+            && isPlaying == o.isPlaying && minDb == o.minDb && maxDb == o.maxDb
+            && waterfallRate == o.waterfallRate && extraVfos == o.extraVfos
+            && stereo == o.stereo && deemphasisUs == o.deemphasisUs && audioAgc == o.audioAgc
+            && samSideband == o.samSideband
+            && squelchDb == o.squelchDb && ctcssHz == o.ctcssHz && dcsCode == o.dcsCode
+            && noiseBlanker == o.noiseBlanker && noiseReduction == o.noiseReduction
+            && autoNotch == o.autoNotch && discriminator == o.discriminator
+            && isRecording == o.isRecording && recMode == o.recMode && recPath == o.recPath;
+    }
+};
+
+// Discrete control changes, applied by the DSP thread between two blocks so a block
+// is never processed with half-applied settings
+enum class CommandType { TUNE, GAIN, MODE, SEEK };
+
+struct Command {
+    CommandType type;
+    long long hz = 0;       // TUNE: new center frequency
+    double value = 0.0;     // GAIN: dB (-1 is AUTO), SEEK: position 0..1
+    Mode mode = Mode::NFM;  // MODE
+};
+
+const size_t COMMAND_QUEUE_SIZE = 256;
+
+// Lock-free channels between the UI and DSP threads
+struct SharedData {
+    TripleBuffer<ControlParams> params;                            // UI -> DSP
+    SpscQueue<Command> commands {COMMAND_QUEUE_SIZE};              // UI -> DSP
+    TripleBuffer<SpectrumFrame> spectrumFrames {SpectrumFrame()};  // DSP -> UI
+    SpscQueue<WaterfallRow> waterfallRows {WATERFALL_QUEUE_ROWS};  // DSP -> UI
+    TripleBuffer<std::string> recStatus {std::string("Idle")};     // DSP -> UI, Do wyświetlania nazwy pliku
+    TripleBuffer<ReceiverStatus> rxStatus;                         // DSP -> UI
 };
 
 std::mutex sourceMtx;
@@ -173,84 +182,233 @@ void drawGrid(sf::RenderWindow& window, const sf::Font& font, float x, float y,
     }
 }
 
+// Windowed FFT of the first FFT_SIZE samples (zero padded), as dB per bin with DC in the middle
+void computeSpectrumDb(const Complex* data, size_t count, const std::vector<double>& win, const FFTPlan& plan, std::vector<Complex>& work, std::vector<float>& dbOut) {
+    for (size_t i = 0; i < FFT_SIZE; i++) work[i] = (i < count) ? data[i] * win[i] : Complex(0, 0);
+    plan.forward(work.data());
+    for (int i = 0; i < FFT_SIZE; i++) {
+        int idx = (i + FFT_SIZE / 2) % FFT_SIZE;
+        float mag = std::abs(work[idx]) / FFT_SIZE;
+        dbOut[i] = 20 * std::log10(mag + 1e-12);
+    }
+}
+
+void colorizeRow(const std::vector<float>& db, float minDb, float maxDb, uint8_t* out) {
+    for (int x = 0; x < SPEC_W; x++) {
+        int fftIdx = (int)((float)x / SPEC_W * FFT_SIZE);
+        float norm = (db[fftIdx] - minDb) / (maxDb - minDb);
+        sf::Color c = getHeatmap(norm);
+        int px = x * 4; out[px] = c.r; out[px + 1] = c.g; out[px + 2] = c.b; out[px + 3] = 255;
+    }
+}
+
+// Spectrum trace once per block and waterfall rows on stream time, published to the UI
+class SpectrumNode : public Node {
+public:
+    InputPort<Complex> in {this};
+    // Set by the DSP thread before each run
+    double sampleRate = 0.0;
+    float minDb = -100.0f, maxDb = 0.0f, rowsPerSecond = 60.0f;
+
+    explicit SpectrumNode(SharedData& s) : Node("spectrum"), shared(s), winFunc(makeWindow(FFT_SIZE)),
+        history(FFT_SIZE, -100.0), fftWork(FFT_SIZE), fftPlan(FFT_SIZE), specDb(FFT_SIZE) {}
+
+    size_t work() override {
+        int count = (int)in.available();
+        if (count == 0) return 0;
+        const Complex* iq = in.data();
+
+        computeSpectrumDb(iq, count, winFunc, fftPlan, fftWork, specDb);
+        for (int i = 0; i < FFT_SIZE; i++) history[i] = history[i] * 0.7 + specDb[i] * 0.3;
+        SpectrumFrame& frame = shared.spectrumFrames.writeBuffer();
+        std::copy(history.begin(), history.end(), frame.spectrum.begin());
+        shared.spectrumFrames.publish();
+
+        // Waterfall rows at every due position inside this block (a full queue drops the row)
+        double samplesPerRow = sampleRate / std::max(rowsPerSecond, 1.0f);
+        for (; rowCountdown < count; rowCountdown += samplesPerRow) {
+            int pos = std::max(0, std::min((int)rowCountdown, count - FFT_SIZE));
+            if (pos > 0) computeSpectrumDb(iq + pos, count - pos, winFunc, fftPlan, fftWork, specDb);
+            WaterfallRow* row = shared.waterfallRows.beginWrite();
+            if (!row) continue;
+            colorizeRow(specDb, minDb, maxDb, row->pixels.data());
+            row->timestamp = (streamSamples + (uint64_t)rowCountdown) / sampleRate;
+            shared.waterfallRows.commitWrite();
+        }
+        rowCountdown -= count;
+        streamSamples += count;
+        in.consume(count);
+        return count;
+    }
+
+private:
+    SharedData& shared;
+    std::vector<double> winFunc;
+    std::vector<double> history;
+    std::vector<Complex> fftWork;
+    FFTPlan fftPlan;
+    std::vector<float> specDb;
+
+    // Waterfall rows are emitted on stream time, independent of block size and UI frame rate
+    double rowCountdown = 0.0;  // samples until the next row is due
+    uint64_t streamSamples = 0; // samples consumed since start, for row timestamps
+};
+
+// Prints RDS fields of the main VFO once they are complete and whenever they change
+void logRds(const RdsInfo& now, RdsInfo& logged) {
+    auto trimmed = [](const char* text) {
+        std::string s(text);
+        s.erase(s.find_last_not_of(' ') + 1);
+        return s;
+    };
+    if (!now.hasPi) { logged.clear(); return; } // retuned: log the next station again
+    if (!logged.hasPi || now.pi != logged.pi) {
+        std::cout << "[RDS] PI " << std::hex << std::uppercase << std::setw(4) << std::setfill('0') << now.pi
+                  << std::dec << std::nouppercase << std::setfill(' ') << std::endl;
+    }
+    if (now.psComplete && std::strcmp(now.ps, logged.ps) != 0) std::cout << "[RDS] PS \"" << now.ps << "\", PTY " << now.pty << std::endl;
+    if (now.rtComplete && std::strcmp(now.rt, logged.rt) != 0) std::cout << "[RDS] RT \"" << trimmed(now.rt) << "\"" << std::endl;
+    if (now.ct[0] && std::strcmp(now.ct, logged.ct) != 0) std::cout << "[RDS] CT " << now.ct << std::endl;
+
+    logged.hasPi = true; logged.pi = now.pi;
+    if (now.psComplete) std::memcpy(logged.ps, now.ps, sizeof(logged.ps));
+    if (now.rtComplete) std::memcpy(logged.rt, now.rt, sizeof(logged.rt));
+    std::memcpy(logged.ct, now.ct, sizeof(logged.ct));
+}
+
 // --- DSP WORKER (Zmodyfikowany o nagrywanie i Gain) ---
 void dspWorker(std::atomic<bool>& running, SharedData& shared, AudioSink& audio) {
-    Demodulator demod(2000000, AUDIO_RATE); 
-    double lastSampleRate = 0;
-    std::vector<Complex> iqBuffer;
-    std::vector<double> winFunc = makeWindow(FFT_SIZE);
-    std::vector<double> localFftHistory(FFT_SIZE, -100.0);
-    
-    WavWriter recorder;
-    float lastRfGain = -999.0f; // do wykrywania zmian
+    ThreadPool pool;
+    VfoBank vfoBank(pool, AUDIO_RATE);
+    std::vector<VfoSettings> vfoList; // main VFO + extra VFOs, as last handed to the bank
+    WavWriter recorder; // baseband; audio is recorded per VFO by the bank
+    WavWriter channelRecorders[ChannelizerNode::MAX_OUTPUTS];
+
+    // source -> { demodulators, spectrum, baseband recorder, channelizer } -> { audio out, channel recorders }
+    SourceNode sourceNode;
+    VfoBankNode demodNode(vfoBank);
+    SpectrumNode spectrumNode(shared);
+    IqRecorderNode iqRecorderNode(recorder);
+    ChannelizerNode channelizerNode;
+    AudioSinkNode audioNode(audio);
+    std::vector<std::unique_ptr<IqRecorderNode>> channelRecorderNodes;
+    Pipeline pipeline(pool);
+    pipeline.connect(sourceNode.out, demodNode.in);
+    pipeline.connect(sourceNode.out, spectrumNode.in);
+    pipeline.connect(sourceNode.out, iqRecorderNode.in);
+    pipeline.connect(sourceNode.out, channelizerNode.in);
+    pipeline.connect(demodNode.left, audioNode.left);
+    pipeline.connect(demodNode.right, audioNode.right);
+    for (size_t i = 0; i < ChannelizerNode::MAX_OUTPUTS; i++) {
+        channelRecorderNodes.push_back(std::make_unique<IqRecorderNode>(channelRecorders[i], "channel rec " + std::to_string(i)));
+        pipeline.connect(channelizerNode.out[i], channelRecorderNodes.back()->in);
+    }
+    auto stopChannelRecorders = [&] {
+        for (WavWriter& w : channelRecorders) if (w.active) w.stop();
+        channelizerNode.select({}, 0.0);
+    };
+    bool recording = false;
+    RecMode rMode = RecMode::AUDIO;
+    Mode mode = Mode::NFM;
+    RdsInfo loggedRds;
+    std::vector<Command> pendingCmds; pendingCmds.reserve(COMMAND_QUEUE_SIZE);
+    // What vfoList was built from; the bank is only reconfigured when one of them changes
+    uint64_t syncedVersion = 0; Mode syncedMode = mode; double syncedRate = 0.0;
+
+    // Snapshot slot stays valid until the next update(), so it is read in place without copying
+    const ControlParams* params = &shared.params.readBuffer();
+
+    auto startRecording = [&](IQSource& src) {
+        long long currentCenterHz = params->centerFreq;
+        const std::string& rPath = params->recPath;
+        rMode = params->recMode;
+
+        char timeBuf[32]; std::time_t now = std::time(nullptr);
+        std::strftime(timeBuf, sizeof(timeBuf), "%Y%m%d_%H%M%S", std::localtime(&now));
+        
+        std::string filename;
+        std::string freqLabel;
+
+        if (rMode == RecMode::AUDIO) {
+            // One file per VFO, format: rec_<time>_102500kHz_audio.wav
+            std::string prefix = "rec_" + std::string(timeBuf);
+            if (!rPath.empty()) prefix = rPath + "/" + prefix;
+            filename = vfoBank.startRecording(prefix);
+        } else if (rMode == RecMode::CHANNELS) {
+            // Channel under the main VFO and the first extra ones (one file per channel), format:
+            // rec_<time>_<channel center>Hz_channel_IQ.wav
+            double sr = src.getSampleRate();
+            std::vector<double> offsets = {(params->tunedFreqPercent - 0.5) * sr};
+            for (const VfoSettings& v : params->extraVfos) {
+                if (offsets.size() == ChannelizerNode::MAX_OUTPUTS) break;
+                offsets.push_back((double)(v.freqHz - currentCenterHz));
+            }
+            channelizerNode.select(offsets, sr);
+
+            std::string prefix = "rec_" + std::string(timeBuf);
+            if (!rPath.empty()) prefix = rPath + "/" + prefix;
+            for (size_t i = 0; i < offsets.size(); i++) {
+                double center = channelizerNode.channelCenter(i);
+                bool duplicate = false; // VFOs in one channel share its file
+                for (size_t j = 0; j < i; j++) duplicate = duplicate || channelizerNode.channelCenter(j) == center;
+                if (duplicate) continue;
+                std::string name = prefix + "_" + std::to_string(currentCenterHz + (long long)center) + "Hz_channel_IQ.wav";
+                channelRecorders[i].start(name, (uint32_t)channelizerNode.channelRate(), 2);
+                if (filename.empty()) filename = name;
+            }
+        } else {
+            // use center frequency for iq filename
+            freqLabel = "_" + std::to_string(currentCenterHz) + "Hz";
+
+            if (rPath.empty()) filename = "rec_" + std::string(timeBuf) + freqLabel + "_IQ.wav";
+            else filename = rPath + "/rec_" + std::string(timeBuf) + freqLabel + "_IQ.wav";
+
+            recorder.start(filename, (int)src.getSampleRate(), 2);
+        }
+        recording = true;
+        shared.recStatus.writeBuffer() = "REC: " + filename; shared.recStatus.publish();
+    };
 
     while (running) {
+        // Commands are taken first and the snapshot refreshed after, so it already holds
+        // every setting the UI published before sending them. The queue is drained even
+        // without a source, so it cannot fill up while none is open.
+        pendingCmds.clear();
+        for (Command cmd; shared.commands.pop(cmd);) pendingCmds.push_back(cmd);
+        if (shared.params.update()) params = &shared.params.readBuffer();
+
+        // Block boundary: apply commands in order; for tune/gain/seek only the newest one matters
+        long long tuneHz = -1; double gainDb = 0.0; bool gainReq = false; double seekPct = -1.0;
+        for (const Command& cmd : pendingCmds) {
+            switch (cmd.type) {
+                case CommandType::TUNE: tuneHz = cmd.hz; break;
+                case CommandType::GAIN: gainDb = cmd.value; gainReq = true; break;
+                case CommandType::SEEK: seekPct = cmd.value; break;
+                case CommandType::MODE: mode = cmd.mode; break;
+            }
+        }
+
         std::shared_ptr<IQSource> src = nullptr;
         { std::lock_guard<std::mutex> lock(sourceMtx); src = currentSource; }
         
         if (!src) { std::this_thread::sleep_for(std::chrono::milliseconds(10)); continue; }
 
-        double targetFreqPct, bw; 
-        float vol, rfGainReq; bool muted;
-        Mode mode; bool play; float minDb, maxDb;
-        bool doRecord; RecMode rMode; std::string rPath;
-        
-        {
-            std::lock_guard<std::mutex> lock(shared.mtx);
-            targetFreqPct = shared.tunedFreqPercent; 
-            bw = shared.bandwidth;
-            vol = shared.volume; muted = shared.isMuted;
-            rfGainReq = shared.rfGain;
-            mode = shared.mode; play = shared.isPlaying;
-            minDb = shared.minDb; maxDb = shared.maxDb;
-            
-            doRecord = shared.isRecording;
-            rMode = shared.recMode;
-            rPath = shared.recPath;
-        }
+        if (tuneHz >= 0 && src->isHardware()) src->setCenterFrequency(tuneHz);
+        // OBSŁUGA RF GAIN (Sprzętowa), -1 to Auto, w przeciwnym razie wartość dB
+        if (gainReq && src->isHardware()) src->setGain((int)gainDb);
+        if (seekPct >= 0.0 && src->isSeekable()) src->seek(seekPct);
 
-        // OBSŁUGA RF GAIN (Sprzętowa)
-        if (src->isHardware() && std::abs(rfGainReq - lastRfGain) > 0.1f) {
-            // Jeśli -1 to Auto, w przeciwnym razie wartość dB
-            src->setGain((int)rfGainReq); 
-            lastRfGain = rfGainReq;
+        // Recording follows the snapshot
+        if (params->isRecording && !recording) startRecording(*src);
+        if (!params->isRecording && recording) {
+            recorder.stop(); vfoBank.stopRecording(); stopChannelRecorders(); recording = false;
+            shared.recStatus.writeBuffer() = "Saved."; shared.recStatus.publish();
         }
 
-        if (doRecord && !recorder.active) {
-             long long currentCenterHz;
-             { std::lock_guard<std::mutex> l(shared.mtx); currentCenterHz = shared.centerFreq; }
-
-             char timeBuf[32]; std::time_t now = std::time(nullptr);
-             std::strftime(timeBuf, sizeof(timeBuf), "%Y%m%d_%H%M%S", std::localtime(&now));
-             
-             std::string filename;
-             std::string freqLabel;
-
-             if (rMode == RecMode::AUDIO) {
-                 double offset = (targetFreqPct - 0.5) * src->getSampleRate();
-                 long long tunedHz = currentCenterHz + (long long)offset;
-                 
-                 // Format: 102500kHz
-                 freqLabel = "_" + std::to_string(tunedHz / 1000) + "kHz";
-                 
-                 if (rPath.empty()) filename = "rec_" + std::string(timeBuf) + freqLabel + "_audio.wav";
-                 else filename = rPath + "/rec_" + std::string(timeBuf) + freqLabel + "_audio.wav";
-
-                 recorder.start(filename, (int)AUDIO_RATE, 1);
-             } else {
-                 // use center frequency for iq filename
-                 freqLabel = "_" + std::to_string(currentCenterHz) + "Hz";
-
-                 if (rPath.empty()) filename = "rec_" + std::string(timeBuf) + freqLabel + "_IQ.wav";
-                 else filename = rPath + "/rec_" + std::string(timeBuf) + freqLabel + "_IQ.wav";
-
-                 recorder.start(filename, (int)src->getSampleRate(), 2);
-             }
-             { std::lock_guard<std::mutex> l(shared.mtx); shared.recStatus = "REC: " + filename; }
-        } else if (!doRecord && recorder.active) {
-             recorder.stop();
-             { std::lock_guard<std::mutex> l(shared.mtx); shared.recStatus = "Saved."; }
-        }
+        double targetFreqPct = params->tunedFreqPercent, bw = params->bandwidth;
+        float vol = params->volume; bool muted = params->isMuted;
+        bool play = params->isPlaying; float minDb = params->minDb, maxDb = params->maxDb;
+        float wfRate = params->waterfallRate;
 
 
         if (!play) { std::this_thread::sleep_for(std::chrono::milliseconds(50)); continue; }
@@ -258,78 +416,62 @@ void dspWorker(std::atomic<bool>& running, SharedData& shared, AudioSink& audio)
         if (!src->isHardware()) {
             while (audio.getBufferedCount() > (AUDIO_RATE * 0.2)) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(5));
-                if (!running) return;
+                if (!running) { pipeline.printProfile(std::cout); return; }
             }
         }
 
         double sr = src->getSampleRate();
-        if (sr != lastSampleRate) { demod = Demodulator(sr, AUDIO_RATE); lastSampleRate = sr; }
-
         int chunkSize = (int)sr / 60; 
         if (chunkSize > 200000) chunkSize = 200000;
-        if (iqBuffer.size() != chunkSize) iqBuffer.resize(chunkSize);
-
-        int readCount = src->read(iqBuffer.data(), chunkSize);
-
-        if (readCount > 0) {
-            // Recording Baseband (IQ)
-            if (recorder.active && rMode == RecMode::BASEBAND) {
-                // convert IQ (Complex) to float array (L R L R)
-                std::vector<float> rawFloat(readCount * 2);
-                for(int i=0; i<readCount; i++) {
-                    rawFloat[i*2] = (float)iqBuffer[i].real();
-                    rawFloat[i*2+1] = (float)iqBuffer[i].imag();
-                }
-                recorder.write(rawFloat.data(), rawFloat.size());
-            }
-
-            double freqOffset = (targetFreqPct - 0.5) * sr;
-            if (mode == Mode::USB) freqOffset += bw / 2.0;
-            if (mode == Mode::LSB) freqOffset -= bw / 2.0;
 
-            std::vector<Complex> chunkToProcess(iqBuffer.begin(), iqBuffer.begin() + readCount);
-            auto audioData = demod.process(chunkToProcess, freqOffset, bw, mode);
-            
-            // Aplikacja GŁOŚNOŚCI (Volume)
-            float finalVol = muted ? 0.0f : vol;
-            for (auto& s : audioData) s *= finalVol;
-            
-            audio.pushSamples(audioData);
-
-            // Nagrywanie Audio
-            if (recorder.active && rMode == RecMode::AUDIO) {
-                recorder.write(audioData.data(), audioData.size());
-            }
+        if (params->version != syncedVersion || mode != syncedMode || sr != syncedRate) {
+            // Main VFO (id 0) follows the tuner, extra VFOs keep their absolute frequency
+            vfoList.clear();
+            VfoSettings& mainVfo = vfoList.emplace_back();
+            mainVfo.freqHz = params->centerFreq + (long long)((targetFreqPct - 0.5) * sr);
+            mainVfo.bandwidthHz = bw; mainVfo.mode = mode; mainVfo.volume = vol;
+            mainVfo.stereo = params->stereo; mainVfo.deemphasisUs = params->deemphasisUs;
+            mainVfo.agc.enabled = params->audioAgc; mainVfo.samSideband = params->samSideband;
+            mainVfo.squelch.enabled = params->squelchDb > SQUELCH_OFF_DB; mainVfo.squelch.thresholdDb = params->squelchDb;
+            mainVfo.squelch.ctcssHz = params->ctcssHz; mainVfo.squelch.dcsCode = params->dcsCode;
+            mainVfo.noiseBlanker.enabled = params->noiseBlanker;
+            mainVfo.noiseReduction.enabled = params->noiseReduction > 0.0f; mainVfo.noiseReduction.strength = params->noiseReduction;
+            mainVfo.autoNotch.enabled = params->autoNotch;
+            mainVfo.discriminator = params->discriminator;
+            vfoList.insert(vfoList.end(), params->extraVfos.begin(), params->extraVfos.end());
+            // Aplikacja GŁOŚNOŚCI (Volume) happens inside the demodulators' final stage
+            if (muted) for (VfoSettings& v : vfoList) v.volume = 0.0f;
+
+            vfoBank.sync(vfoList, params->centerFreq, sr);
+            syncedVersion = params->version; syncedMode = mode; syncedRate = sr;
+        }
 
-            // FFT Processing (Standard)
-            std::vector<Complex> fftData(FFT_SIZE);
-            for (size_t i = 0; i < FFT_SIZE && i < chunkToProcess.size(); i++) fftData[i] = chunkToProcess[i] * winFunc[i];
-            fft(fftData);
-            std::vector<uint8_t> tempRow(SPEC_W * 4);
-            for (int x = 0; x < SPEC_W; x++) {
-                int fftIdx = (int)((float)x / SPEC_W * FFT_SIZE);
-                int shiftedIdx = (fftIdx + FFT_SIZE / 2) % FFT_SIZE;
-                float rawMag = std::abs(fftData[shiftedIdx]) / FFT_SIZE;
-                float rawDb = 20 * std::log10(rawMag + 1e-12);
-                float norm = (rawDb - minDb) / (maxDb - minDb); 
-                sf::Color c = getHeatmap(norm);
-                int px = x * 4; tempRow[px] = c.r; tempRow[px + 1] = c.g; tempRow[px + 2] = c.b; tempRow[px + 3] = 255;
-            }
-            for (int i = 0; i < FFT_SIZE; i++) {
-                 int idx = (i + FFT_SIZE / 2) % FFT_SIZE;
-                 float mag = std::abs(fftData[idx]) / FFT_SIZE;
-                 float db = 20 * std::log10(mag + 1e-12);
-                 localFftHistory[i] = localFftHistory[i] * 0.7 + db * 0.3;
-            }
-            {
-                std::lock_guard<std::mutex> lock(shared.mtx);
-                shared.fftSpectrum = localFftHistory;
-                shared.waterfallRow = tempRow;
-                shared.newWaterfallData = true;
-            }
+        // One block through the graph; the demodulators, spectrum and baseband recorder run
+        // in parallel on the pool, each stream keeps its block order
+        sourceNode.source = src;
+        sourceNode.request(chunkSize);
+        spectrumNode.sampleRate = sr; spectrumNode.minDb = minDb; spectrumNode.maxDb = maxDb;
+        spectrumNode.rowsPerSecond = wfRate;
+        pipeline.run();
+
+        if (sourceNode.lastRead > 0) {
+            const VfoBank::Vfo* primary = vfoBank.find(0);
+            ReceiverStatus& status = shared.rxStatus.writeBuffer();
+            status.stereo = primary && mode == Mode::WFM && primary->demod.stereoDetected;
+            if (primary && mode == Mode::WFM) status.rds = primary->demod.rds.info;
+            else status.rds.clear();
+            status.squelchOpen = !primary || primary->demod.squelchOpen();
+            status.powerDb = primary ? primary->demod.squelch.powerDb : -150.0f;
+            status.ctcssHz = primary && mode == Mode::NFM ? primary->demod.squelch.tones.ctcssHz : 0.0f;
+            status.dcsCode = primary && mode == Mode::NFM ? primary->demod.squelch.tones.dcsCode : 0;
+            shared.rxStatus.publish();
+            logRds(status.rds, loggedRds);
         } else { std::this_thread::sleep_for(std::chrono::milliseconds(10)); }
     }
     if (recorder.active) recorder.stop();
+    vfoBank.stopRecording();
+    stopChannelRecorders();
+    pipeline.printProfile(std::cout);
 }
 
 int main() {
@@ -347,7 +489,28 @@ int main() {
     audio.start();
 
     SharedData sharedData;
-    sharedData.isPlaying = false;
+    ControlParams uiParams;        // UI-thread working copy
+    ControlParams publishedParams; // last snapshot handed to the DSP thread
+    Mode currentMode = Mode::NFM;
+    float sentRfGain = -1.0f;
+    int nextVfoId = 1; // 0 is the main VFO
+
+    // Hands pending settings to the DSP first, so a command never overtakes the snapshot it depends on
+    auto publishParams = [&]() {
+        if (uiParams.sameSettings(publishedParams)) return;
+        uiParams.version++;
+        publishedParams = uiParams;
+        sharedData.params.writeBuffer() = uiParams;
+        sharedData.params.publish();
+    };
+    auto sendCommand = [&](Command cmd) {
+        publishParams();
+        if (!sharedData.commands.push(cmd)) std::cerr << "[Control] Command queue full, dropping command." << std::endl;
+    };
+    // Drags retune / seek on every mouse move; only the newest value is sent, once per frame
+    long long pendingTuneHz = -1;
+    double pendingSeek = -1.0;
+    std::string currentFilename = "None";
 
     std::atomic<bool> dspRunning {true};
     std::thread dspThread(dspWorker, std::ref(dspRunning), std::ref(sharedData), std::ref(audio));
@@ -393,9 +556,11 @@ int main() {
     Slider rfGainSlider(px, sliderY, 160, 0.0f, 50.0f, 0.0f, "RF Gain (dB)", font);
     SdrButton btnAgc(px + 170, sliderY - 5, 30, 30, "A", font); // Auto Gain Button
     btnAgc.setActive(true); // Domyślnie Auto
+    // DC / IQ imbalance correction of the current source (RTL-SDR: on by default)
+    SdrButton btnIqCorr(px + 205, sliderY - 5, 30, 30, "IQ", font);
     bool agcEnabled = true;
 
-    Slider bwSlider(px, sliderY+50, 200, 1000.0f, 220000.0f, 12000.0f, "Filter BW (Hz)", font);
+    Slider bwSlider(px, sliderY+50, 200, 200.0f, 220000.0f, 12000.0f, "Filter BW (Hz)", font);
     Slider minDbSlider(px, sliderY+100, 200, -120.0f, -20.0f, -90.0f, "Min dB", font);
     Slider maxDbSlider(px, sliderY+150, 200, -40.0f, 40.0f, 0.0f, "Max dB", font);
 
@@ -404,12 +569,33 @@ int main() {
     SdrButton btnAM(px + 50, btnY, 45, 30, "AM", font);
     SdrButton btnWFM(px + 100, btnY, 45, 30, "WFM", font);
     SdrButton btnOFF(px + 150, btnY, 45, 30, "OFF", font);
-    SdrButton btnLSB(px, btnY+40, 95, 30, "LSB", font);
-    SdrButton btnUSB(px + 100, btnY+40, 95, 30, "USB", font);
+    SdrButton btnCW(px + 200, btnY, 45, 30, "CW", font);
+    SdrButton btnLSB(px, btnY+40, 45, 30, "LSB", font);
+    SdrButton btnUSB(px + 50, btnY+40, 45, 30, "USB", font);
+    // WFM: stereo on/off and de-emphasis 50/75 us
+    SdrButton btnStereo(px + 100, btnY+40, 45, 30, "ST", font); btnStereo.setActive(true);
+    SdrButton btnDeemph(px + 150, btnY+40, 45, 30, "50us", font);
+    // Audio AGC on/off
+    SdrButton btnAudioAgc(px + 200, btnY+40, 45, 30, "AGC", font); btnAudioAgc.setActive(true);
+    // Synchronous AM and the sideband it plays (DSB / USB / LSB)
+    SdrButton btnSAM(px, btnY+80, 45, 30, "SAM", font);
+    SdrButton btnSamSide(px + 50, btnY+80, 45, 30, "DSB", font);
+    // Squelch: carrier threshold (off at the minimum); TONE requires the CTCSS / DCS currently received
+    Slider sqlSlider(px + 110, btnY+100, 130, SQUELCH_OFF_DB, 0.0f, SQUELCH_OFF_DB, "Squelch (dB)", font);
+    SdrButton btnTone(px, btnY+120, 45, 30, "TONE", font);
+    // Impulse noise blanker on/off
+    SdrButton btnNb(px + 50, btnY+120, 45, 30, "NB", font);
+    // Audio noise reduction: off -> NR1 -> NR2 -> NR3 (strength 0.3 / 0.6 / 1.0)
+    SdrButton btnNr(px + 100, btnY+120, 45, 30, "NR", font);
+    // Automatic notch for carriers (AM / SSB)
+    SdrButton btnAnf(px + 150, btnY+120, 45, 30, "ANF", font);
+    // FM discriminator (NFM / WFM): POLY (polynomial atan) -> ATAN (std::arg) -> FAST (cross product)
+    SdrButton btnDisc(px + 200, btnY+120, 45, 30, "POLY", font);
+    sf::Text toneText(font, "", 12); toneText.setPosition({(float)px, (float)btnY + 155});
     btnNFM.setActive(true); 
 
     // --- NOWOŚĆ: PANEL NAGRYWANIA ---
-    int recY = btnY + 90;
+    int recY = btnY + 180;
     sf::RectangleShape recPanel({260, 130});
     recPanel.setPosition({(float)px - 10, (float)recY});
     recPanel.setFillColor(sf::Color(40,40,40)); recPanel.setOutlineColor(sf::Color::White); recPanel.setOutlineThickness(1);
@@ -418,6 +604,7 @@ int main() {
     
     SdrButton btnRecAudio(px, recY + 30, 80, 25, "Audio", font); btnRecAudio.setActive(true);
     SdrButton btnRecIQ(px + 90, recY + 30, 80, 25, "Baseband", font); 
+    SdrButton btnRecChannels(px + 180, recY + 30, 65, 25, "Channels", font);
     RecMode currentRecMode = RecMode::AUDIO;
 
     sf::Text pathText(font, "Path: ./ (Default)", 10); pathText.setPosition({(float)px, (float)recY + 65}); pathText.setFillColor(sf::Color::Cyan);
@@ -426,20 +613,39 @@ int main() {
     SdrButton btnRecStart(px + 120, recY + 80, 60, 35, "REC", font); /*btnRecStart.setColor(sf::Color(150,0,0));*/
     std::string currentRecPath = "";
 
+    Slider wfSpeedSlider(px, recY + 165, 200, 5.0f, 200.0f, 60.0f, "Waterfall (rows/s)", font);
+
+    // Extra VFOs: "+VFO" adds one on the tuned frequency, "Out" routes the newest one (mix or a device)
+    SdrButton btnVfoAdd(px, recY + 195, 60, 25, "+VFO", font);
+    SdrButton btnVfoDel(px + 65, recY + 195, 60, 25, "-VFO", font);
+    SdrButton btnVfoOut(px + 130, recY + 195, 70, 25, "Mix", font);
+
     Slider timeSlider(20, W_HEIGHT - 30, W_WIDTH - 40, 0.0f, 1.0f, 0.0f, "Timeline", font);
 
-    // Waterfall Textures
-    std::vector<std::uint8_t> waterfall(SPEC_W * WATERFALL_H * 4, 0);
+    // Waterfall Texture (circular: each new row overwrites the oldest one at wHead, newest is drawn on top)
     sf::Texture wTex; if (!wTex.resize({(unsigned)SPEC_W, (unsigned)WATERFALL_H})) return 1;
-    sf::Sprite wSpr(wTex); wSpr.setPosition({0, (float)SPEC_H + TOP_BAR_H}); 
+    sf::Sprite wSprTop(wTex), wSprBottom(wTex);
+    int wHead = 0;
+    std::vector<double> wRowTime(WATERFALL_H, -1.0); // stream timestamp of each texture row, -1 = empty
+    auto clearWaterfall = [&]() {
+        std::vector<std::uint8_t> blank(SPEC_W * WATERFALL_H * 4, 0);
+        wTex.update(blank.data());
+        wHead = 0;
+        std::fill(wRowTime.begin(), wRowTime.end(), -1.0);
+    };
+    clearWaterfall();
     
     long long currentCenterFreq = 0;
-    long long pendingCenterFreq = 0;
-    sf::Clock debouncer;
+    long long pendingCenterFreq = 0; // center mode: retune once the tuner drag ends
+
+    auto tuneTo = [&](long long hz) {
+        currentCenterFreq = hz;
+        pendingTuneHz = hz;
+    };
 
     auto resetBtns = [&](SdrButton* active) {
         btnNFM.setActive(false); btnAM.setActive(false); btnWFM.setActive(false); 
-        btnOFF.setActive(false); btnLSB.setActive(false); btnUSB.setActive(false);
+        btnOFF.setActive(false); btnLSB.setActive(false); btnUSB.setActive(false); btnCW.setActive(false); btnSAM.setActive(false);
         active->setActive(true);
     };
 
@@ -458,10 +664,9 @@ int main() {
             newSource = std::make_shared<FileSource>(); 
             std::string path = pathOverride.empty() ? "None" : pathOverride;
             { 
-                std::lock_guard<std::mutex> lock(sharedData.mtx);
                 size_t lastSlash = path.find_last_of("/\\");
-                sharedData.currentFilename = (lastSlash == std::string::npos) ? path : path.substr(lastSlash + 1);
-                std::string fn = sharedData.currentFilename;
+                currentFilename = (lastSlash == std::string::npos) ? path : path.substr(lastSlash + 1);
+                std::string fn = currentFilename;
                 long long parsedFreq = 0;
                 bool foundFreq = false;
                 size_t hzPos = fn.find("Hz");
@@ -485,7 +690,7 @@ int main() {
                 }
             }
             newSource->open(path);
-            rateDropdown.setOptions({sharedData.currentFilename});
+            rateDropdown.setOptions({currentFilename});
         } else if (sourceIdx == 1) { 
             newSource = std::make_shared<RtlSdrSource>();
             rateDropdown.setOptions(newSource->getAvailableSampleRatesText()); rateDropdown.setSelection(rateIdx);
@@ -504,11 +709,13 @@ int main() {
         }
 
         { std::lock_guard<std::mutex> lock(sourceMtx); currentSource = newSource; }
-        { std::lock_guard<std::mutex> lock(sharedData.mtx); sharedData.isPlaying = false; sharedData.isRecording = false; }
+        btnIqCorr.setActive(newSource->getIqCorrection());
+        uiParams.isPlaying = false; uiParams.isRecording = false;
         isPlaying = false; btnRecStart.setText("REC"); //btnRecStart.setColor(sf::Color(150,0,0));
-        audio.stop(); btnPlay.setText(">"); btnPlay.setColor(sf::Color(116, 57, 57)); audio.clear(); std::fill(waterfall.begin(), waterfall.end(), 0);
+        audio.stop(); btnPlay.setText(">"); btnPlay.setColor(sf::Color(116, 57, 57)); audio.clear(); clearWaterfall();
     };
 
+    float mouseX = -1.0f, mouseY = -1.0f; // spectrum/waterfall hover position
     bool isDraggingScale = false;
     bool isDraggingTuner = false;
     float lastDragX = 0.0f;
@@ -517,24 +724,27 @@ int main() {
     while (window.isOpen()) {
         // Sync UI -> Shared Data
         {
-             std::lock_guard<std::mutex> lock(sharedData.mtx);
-             sharedData.bandwidth = bwSlider.currentVal;
-             sharedData.minDb = minDbSlider.currentVal;
-             sharedData.maxDb = maxDbSlider.currentVal;
-             sharedData.volume = volSlider.currentVal;
-             sharedData.rfGain = agcEnabled ? -1.0f : rfGainSlider.currentVal;
-             sharedData.isMuted = isMuted;
-             sharedData.recMode = currentRecMode;
-             sharedData.recPath = currentRecPath;
-             sharedData.centerFreq = currentCenterFreq;
+             uiParams.bandwidth = bwSlider.currentVal;
+             uiParams.minDb = minDbSlider.currentVal;
+             uiParams.squelchDb = sqlSlider.currentVal;
+             uiParams.maxDb = maxDbSlider.currentVal;
+             uiParams.volume = volSlider.currentVal;
+             uiParams.isMuted = isMuted;
+             uiParams.recMode = currentRecMode;
+             uiParams.recPath = currentRecPath;
+             uiParams.centerFreq = currentCenterFreq;
+             uiParams.waterfallRate = wfSpeedSlider.currentVal;
+
+             int outDev = uiParams.extraVfos.empty() ? -1 : uiParams.extraVfos.back().outputDevice;
+             btnVfoOut.setText(outDev < 0 ? "Mix" : "Out " + std::to_string(outDev + 1));
+
+             float rfGain = agcEnabled ? -1.0f : rfGainSlider.currentVal;
+             if (std::abs(rfGain - sentRfGain) > 0.1f) { sentRfGain = rfGain; sendCommand({CommandType::GAIN, 0, rfGain}); }
              
              // Update status text from recording state
-             if (sharedData.isRecording) {
-                 pathText.setString(sharedData.recStatus);
-                 pathText.setFillColor(sf::Color::Red);
-             } else if (sharedData.recStatus != "Idle") {
-                 pathText.setString(sharedData.recStatus);
-                 pathText.setFillColor(sf::Color::Green);
+             if (sharedData.recStatus.update()) {
+                 pathText.setString(sharedData.recStatus.readBuffer());
+                 pathText.setFillColor(uiParams.isRecording ? sf::Color::Red : sf::Color::Green);
              }
         }
         
@@ -573,18 +783,18 @@ int main() {
                 if (isHw && freqVFO.handleEvent(*ev)) { 
                         long long targetVFO = freqVFO.getFrequency();
                         if (stickyCenterMode) {
-                            pendingCenterFreq = targetVFO; debouncer.restart();
-                            { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.tunedFreqPercent = 0.5; }
+                            tuneTo(targetVFO);
+                            uiParams.tunedFreqPercent = 0.5;
                         } else {
                             double halfBW = hwSampleRate / 2.0;
                             double minF = (double)currentCenterFreq - halfBW; double maxF = (double)currentCenterFreq + halfBW;
-                            if (targetVFO > maxF || targetVFO < minF) { pendingCenterFreq = targetVFO; debouncer.restart(); { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.tunedFreqPercent = 0.5; } } 
-                            else { double pct = 0.5 + ((double)(targetVFO - currentCenterFreq) / hwSampleRate); { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.tunedFreqPercent = pct; } }
+                            if (targetVFO > maxF || targetVFO < minF) { tuneTo(targetVFO); uiParams.tunedFreqPercent = 0.5; } 
+                            else { double pct = 0.5 + ((double)(targetVFO - currentCenterFreq) / hwSampleRate); uiParams.tunedFreqPercent = pct; }
                         }
                 }
                 if (isHw && btnTuningMode.isClicked(*ev, window)) {
                     stickyCenterMode = !stickyCenterMode;
-                    if (stickyCenterMode) { btnTuningMode.setText("CTR"); btnTuningMode.setColor(sf::Color(0, 100, 200)); pendingCenterFreq = freqVFO.getFrequency(); debouncer.restart(); { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.tunedFreqPercent = 0.5; } } 
+                    if (stickyCenterMode) { btnTuningMode.setText("CTR"); btnTuningMode.setColor(sf::Color(0, 100, 200)); tuneTo(freqVFO.getFrequency()); uiParams.tunedFreqPercent = 0.5; } 
                     else { btnTuningMode.setText("FIX"); btnTuningMode.setColor(sf::Color(80, 80, 80)); }
                 }
 
@@ -592,6 +802,8 @@ int main() {
                 volSlider.handleEvent(*ev, window);
                 rfGainSlider.handleEvent(*ev, window);
                 bwSlider.handleEvent(*ev, window); minDbSlider.handleEvent(*ev, window); maxDbSlider.handleEvent(*ev, window);
+                sqlSlider.handleEvent(*ev, window);
+                wfSpeedSlider.handleEvent(*ev, window);
                 if (!isHw) timeSlider.handleEvent(*ev, window);
 
                 // MUTE BTN
@@ -605,10 +817,15 @@ int main() {
                     agcEnabled = !agcEnabled;
                     btnAgc.setActive(agcEnabled);
                 }
+                if (btnIqCorr.isClicked(*ev, window)) {
+                    std::lock_guard<std::mutex> l(sourceMtx);
+                    if (currentSource) { currentSource->setIqCorrection(!currentSource->getIqCorrection()); btnIqCorr.setActive(currentSource->getIqCorrection()); }
+                }
 
                 // REC CONTROLS
-                if (btnRecAudio.isClicked(*ev, window)) { currentRecMode = RecMode::AUDIO; btnRecAudio.setActive(true); btnRecIQ.setActive(false); }
-                if (btnRecIQ.isClicked(*ev, window)) { currentRecMode = RecMode::BASEBAND; btnRecAudio.setActive(false); btnRecIQ.setActive(true); }
+                if (btnRecAudio.isClicked(*ev, window)) { currentRecMode = RecMode::AUDIO; btnRecAudio.setActive(true); btnRecIQ.setActive(false); btnRecChannels.setActive(false); }
+                if (btnRecIQ.isClicked(*ev, window)) { currentRecMode = RecMode::BASEBAND; btnRecAudio.setActive(false); btnRecIQ.setActive(true); btnRecChannels.setActive(false); }
+                if (btnRecChannels.isClicked(*ev, window)) { currentRecMode = RecMode::CHANNELS; btnRecAudio.setActive(false); btnRecIQ.setActive(false); btnRecChannels.setActive(true); }
                 
                 if (btnSelectFolder.isClicked(*ev, window)) {
                     std::string folder = selectFolderDialog();
@@ -622,22 +839,78 @@ int main() {
                 }
 
                 if (btnRecStart.isClicked(*ev, window)) {
-                    bool s; { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.isRecording = !sharedData.isRecording; s = sharedData.isRecording; }
+                    bool s = uiParams.isRecording = !uiParams.isRecording;
                     if (s) { btnRecStart.setText("STOP"); /*btnRecStart.setColor(sf::Color(78,78,236));*/ }
                     else { btnRecStart.setText("REC"); /*btnRecStart.setColor(sf::Color(150,0,0));*/ }
                 }
 
+                // VFOS
+                if (btnVfoAdd.isClicked(*ev, window)) {
+                    VfoSettings v; v.id = nextVfoId++; v.freqHz = freqVFO.getFrequency();
+                    v.bandwidthHz = bwSlider.currentVal; v.mode = currentMode; v.volume = volSlider.currentVal;
+                    v.stereo = uiParams.stereo; v.deemphasisUs = uiParams.deemphasisUs;
+                    v.agc.enabled = uiParams.audioAgc; v.samSideband = uiParams.samSideband;
+                    v.squelch.enabled = uiParams.squelchDb > SQUELCH_OFF_DB; v.squelch.thresholdDb = uiParams.squelchDb;
+                    v.squelch.ctcssHz = uiParams.ctcssHz; v.squelch.dcsCode = uiParams.dcsCode;
+                    v.noiseBlanker.enabled = uiParams.noiseBlanker;
+                    v.noiseReduction.enabled = uiParams.noiseReduction > 0.0f; v.noiseReduction.strength = uiParams.noiseReduction;
+                    v.autoNotch.enabled = uiParams.autoNotch;
+                    v.discriminator = uiParams.discriminator;
+                    uiParams.extraVfos.push_back(v);
+                }
+                if (btnVfoDel.isClicked(*ev, window) && !uiParams.extraVfos.empty()) uiParams.extraVfos.pop_back();
+                if (btnVfoOut.isClicked(*ev, window) && !uiParams.extraVfos.empty()) {
+                    int& dev = uiParams.extraVfos.back().outputDevice;
+                    dev = (dev + 1 < (int)deviceNames.size()) ? dev + 1 : -1;
+                }
+
+                if (btnStereo.isClicked(*ev, window)) { uiParams.stereo = !uiParams.stereo; btnStereo.setActive(uiParams.stereo); }
+                if (btnTone.isClicked(*ev, window)) {
+                    // Locks the squelch to the received tone / code, or clears it
+                    const ReceiverStatus& rx = sharedData.rxStatus.readBuffer();
+                    if (uiParams.ctcssHz > 0.0f || uiParams.dcsCode > 0) { uiParams.ctcssHz = 0.0f; uiParams.dcsCode = 0; }
+                    else { uiParams.ctcssHz = rx.ctcssHz; uiParams.dcsCode = rx.ctcssHz > 0.0f ? 0 : rx.dcsCode; }
+                    btnTone.setActive(uiParams.ctcssHz > 0.0f || uiParams.dcsCode > 0);
+                }
+                if (btnNb.isClicked(*ev, window)) { uiParams.noiseBlanker = !uiParams.noiseBlanker; btnNb.setActive(uiParams.noiseBlanker); }
+                if (btnAnf.isClicked(*ev, window)) { uiParams.autoNotch = !uiParams.autoNotch; btnAnf.setActive(uiParams.autoNotch); }
+                if (btnDisc.isClicked(*ev, window)) {
+                    DiscriminatorType& d = uiParams.discriminator;
+                    d = (d == DiscriminatorType::Polynomial) ? DiscriminatorType::Exact : (d == DiscriminatorType::Exact) ? DiscriminatorType::CrossProduct : DiscriminatorType::Polynomial;
+                    btnDisc.setText(d == DiscriminatorType::Polynomial ? "POLY" : d == DiscriminatorType::Exact ? "ATAN" : "FAST");
+                }
+                if (btnNr.isClicked(*ev, window)) {
+                    const float levels[] = {0.0f, 0.3f, 0.6f, 1.0f};
+                    int level = 0;
+                    while (level < 3 && levels[level] < uiParams.noiseReduction) level++;
+                    level = (level + 1) % 4;
+                    uiParams.noiseReduction = levels[level];
+                    btnNr.setText(level == 0 ? "NR" : "NR" + std::to_string(level));
+                    btnNr.setActive(level > 0);
+                }
+                if (btnAudioAgc.isClicked(*ev, window)) { uiParams.audioAgc = !uiParams.audioAgc; btnAudioAgc.setActive(uiParams.audioAgc); }
+                if (btnDeemph.isClicked(*ev, window)) {
+                    uiParams.deemphasisUs = (uiParams.deemphasisUs == 50.0f) ? 75.0f : 50.0f;
+                    btnDeemph.setText(uiParams.deemphasisUs == 50.0f ? "50us" : "75us");
+                }
+
                 // MODES
-                if (btnNFM.isClicked(*ev, window)) { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.mode = Mode::NFM; resetBtns(&btnNFM); bwSlider.currentVal = 12000; bwSlider.updateHandlePos(); }
-                if (btnAM.isClicked(*ev, window))  { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.mode = Mode::AM; resetBtns(&btnAM); bwSlider.currentVal = 8000; bwSlider.updateHandlePos(); }
-                if (btnWFM.isClicked(*ev, window)) { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.mode = Mode::WFM; resetBtns(&btnWFM); bwSlider.currentVal = 180000; bwSlider.updateHandlePos(); }
-                if (btnOFF.isClicked(*ev, window)) { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.mode = Mode::OFF; resetBtns(&btnOFF); }
-                if (btnLSB.isClicked(*ev, window)) { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.mode = Mode::LSB; resetBtns(&btnLSB); bwSlider.currentVal = 3000; bwSlider.updateHandlePos(); }
-                if (btnUSB.isClicked(*ev, window)) { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.mode = Mode::USB; resetBtns(&btnUSB); bwSlider.currentVal = 3000; bwSlider.updateHandlePos(); }
+                if (btnNFM.isClicked(*ev, window)) { currentMode = Mode::NFM; sendCommand({CommandType::MODE, 0, 0.0, Mode::NFM}); resetBtns(&btnNFM); bwSlider.currentVal = 12000; bwSlider.updateHandlePos(); }
+                if (btnAM.isClicked(*ev, window))  { currentMode = Mode::AM; sendCommand({CommandType::MODE, 0, 0.0, Mode::AM}); resetBtns(&btnAM); bwSlider.currentVal = 8000; bwSlider.updateHandlePos(); }
+                if (btnWFM.isClicked(*ev, window)) { currentMode = Mode::WFM; sendCommand({CommandType::MODE, 0, 0.0, Mode::WFM}); resetBtns(&btnWFM); bwSlider.currentVal = 220000; bwSlider.updateHandlePos(); }
+                if (btnOFF.isClicked(*ev, window)) { currentMode = Mode::OFF; sendCommand({CommandType::MODE, 0, 0.0, Mode::OFF}); resetBtns(&btnOFF); }
+                if (btnLSB.isClicked(*ev, window)) { currentMode = Mode::LSB; sendCommand({CommandType::MODE, 0, 0.0, Mode::LSB}); resetBtns(&btnLSB); bwSlider.currentVal = 3000; bwSlider.updateHandlePos(); }
+                if (btnUSB.isClicked(*ev, window)) { currentMode = Mode::USB; sendCommand({CommandType::MODE, 0, 0.0, Mode::USB}); resetBtns(&btnUSB); bwSlider.currentVal = 3000; bwSlider.updateHandlePos(); }
+                if (btnSAM.isClicked(*ev, window)) { currentMode = Mode::SAM; sendCommand({CommandType::MODE, 0, 0.0, Mode::SAM}); resetBtns(&btnSAM); bwSlider.currentVal = 8000; bwSlider.updateHandlePos(); }
+                if (btnSamSide.isClicked(*ev, window)) {
+                    uiParams.samSideband = (uiParams.samSideband == SamSideband::DSB) ? SamSideband::USB : (uiParams.samSideband == SamSideband::USB) ? SamSideband::LSB : SamSideband::DSB;
+                    btnSamSide.setText(uiParams.samSideband == SamSideband::DSB ? "DSB" : uiParams.samSideband == SamSideband::USB ? "USB" : "LSB");
+                }
+                if (btnCW.isClicked(*ev, window))  { currentMode = Mode::CW; sendCommand({CommandType::MODE, 0, 0.0, Mode::CW}); resetBtns(&btnCW); bwSlider.currentVal = 500; bwSlider.updateHandlePos(); }
 
                 if (btnPlay.isClicked(*ev, window)) {
-                    bool s; { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.isPlaying = !sharedData.isPlaying; s = sharedData.isPlaying; }
-                    if (s) { btnPlay.setText("||"); btnPlay.setColor(sf::Color(78, 78, 236)); audio.start(); { std::lock_guard<std::mutex> l(sourceMtx); if (currentSource) currentSource->start(); } } 
+                    bool s = uiParams.isPlaying = !uiParams.isPlaying;
+                    if (s) { btnPlay.setText("||"); btnPlay.setColor(sf::Color(78, 78, 236)); audio.start(); { std::lock_guard<std::mutex> l(sourceMtx); if (currentSource) currentSource->start(); } sendCommand({CommandType::GAIN, 0, sentRfGain}); } 
                     else { btnPlay.setText(">"); btnPlay.setColor(sf::Color(116, 57, 57)); audio.stop(); { std::lock_guard<std::mutex> l(sourceMtx); if (currentSource) currentSource->stop(); } }
                     isPlaying = s;
                 }
@@ -655,8 +928,8 @@ int main() {
                             double clickPct = m.x / SPEC_W;
                             double offsetHz = (clickPct - 0.5) * hwSampleRate;
                             long long clickedFreq = currentCenterFreq + (long long)offsetHz;
-                            if (stickyCenterMode && isHw) { pendingCenterFreq = clickedFreq; debouncer.restart(); { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.tunedFreqPercent = 0.5; } freqVFO.setFrequency(clickedFreq); } 
-                            else { { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.tunedFreqPercent = clickPct; } freqVFO.setFrequency(clickedFreq); }
+                            if (stickyCenterMode && isHw) { pendingCenterFreq = clickedFreq; uiParams.tunedFreqPercent = 0.5; freqVFO.setFrequency(clickedFreq); } 
+                            else { uiParams.tunedFreqPercent = clickPct; freqVFO.setFrequency(clickedFreq); }
                         }
                     }
                 }
@@ -664,8 +937,8 @@ int main() {
                 if (const auto* me = ev->getIf<sf::Event::MouseMoved>()) {
                     sf::Vector2f m = window.mapPixelToCoords(me->position);
                     float graphY = m.y - TOP_BAR_H;
-                    if (m.x >= 0 && m.x < SPEC_W && graphY >= 0 && graphY < SPEC_H + WATERFALL_H) { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.mouseX_spectrum = m.x; sharedData.mouseY_spectrum = graphY; } 
-                    else { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.mouseX_spectrum = -1.0f; }
+                    if (m.x >= 0 && m.x < SPEC_W && graphY >= 0 && graphY < SPEC_H + WATERFALL_H) { mouseX = m.x; mouseY = graphY; } 
+                    else { mouseX = -1.0f; }
                 }
             }
         }
@@ -699,12 +972,8 @@ int main() {
 
                     lastDragX = m.x;
 
-                    // Send the command to the device (with a time limit to prevent lag)
-                    if (debouncer.getElapsedTime().asMilliseconds() > 30) {
-                        std::lock_guard<std::mutex> l(sourceMtx);
-                        if (currentSource) currentSource->setCenterFrequency(currentCenterFreq);
-                        debouncer.restart();
-                    }
+                    // Send the command to the device (the DSP thread applies only the newest one per block)
+                    tuneTo(currentCenterFreq);
                 }
             }
         }
@@ -732,18 +1001,18 @@ int main() {
                         if (stickyCenterMode && isHw) {
                             // Center Tuning mode
                             pendingCenterFreq = clickedFreq; 
-                            debouncer.restart(); 
-                            { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.tunedFreqPercent = 0.5; }
+                            uiParams.tunedFreqPercent = 0.5;
                             freqVFO.setFrequency(clickedFreq);
                         } else {
                             // Standard mode
-                            { std::lock_guard<std::mutex> l(sharedData.mtx); sharedData.tunedFreqPercent = clickPct; }
+                            uiParams.tunedFreqPercent = clickPct;
                             freqVFO.setFrequency(clickedFreq);
                         }
                     }
                 }
             } else {
                 isDraggingTuner = false;
+                if (pendingCenterFreq != 0) { if (isHw) tuneTo(pendingCenterFreq); pendingCenterFreq = 0; }
             }
         }
         // --- CURSORS ---
@@ -757,6 +1026,7 @@ int main() {
             if (btnMute.shape.getGlobalBounds().contains(m)) hover = true;
             if (btnRecAudio.shape.getGlobalBounds().contains(m)) hover = true;
             if (btnRecIQ.shape.getGlobalBounds().contains(m)) hover = true;
+            if (btnRecChannels.shape.getGlobalBounds().contains(m)) hover = true;
             if (btnSelectFolder.shape.getGlobalBounds().contains(m)) hover = true;
             if (btnRecStart.shape.getGlobalBounds().contains(m)) hover = true;
             
@@ -771,24 +1041,36 @@ int main() {
             if (hover) { if (cursorHand) window.setMouseCursor(*cursorHand); } else { if (cursorArrow) window.setMouseCursor(*cursorArrow); }
         }
 
-        if (pendingCenterFreq != 0 && debouncer.getElapsedTime().asMilliseconds() > 150) {
-             std::lock_guard<std::mutex> l(sourceMtx);
-             if (currentSource && currentSource->isHardware()) { currentSource->setCenterFrequency(pendingCenterFreq); currentCenterFreq = pendingCenterFreq; }
-             pendingCenterFreq = 0;
-        }
-
         if (!sourceDropdown.isOpen) {
              volSlider.update(window);
              rfGainSlider.update(window);
              bwSlider.update(window); minDbSlider.update(window); maxDbSlider.update(window);
+             sqlSlider.update(window);
+             wfSpeedSlider.update(window);
              bool isHw = false; double prog = 0; { std::lock_guard<std::mutex> l(sourceMtx); if (currentSource) { isHw = currentSource->isHardware(); prog = currentSource->getProgress(); } }
-             if (!isHw) { timeSlider.update(window); if (timeSlider.isDragging) { std::lock_guard<std::mutex> l(sourceMtx); if (currentSource) currentSource->seek(timeSlider.currentVal); } else { timeSlider.currentVal = prog; timeSlider.updateHandlePos(); } }
+             if (!isHw) { timeSlider.update(window); if (timeSlider.isDragging) { pendingSeek = timeSlider.currentVal; } else { timeSlider.currentVal = prog; timeSlider.updateHandlePos(); } }
         }
 
-        std::vector<double> spectrum; std::vector<uint8_t> row; bool newRow = false; double tunePct = 0.5; Mode mode = Mode::NFM;
-        { std::lock_guard<std::mutex> lock(sharedData.mtx); spectrum = sharedData.fftSpectrum; if (sharedData.newWaterfallData) { row = sharedData.waterfallRow; sharedData.newWaterfallData = false; newRow = true; } tunePct = sharedData.tunedFreqPercent; mode = sharedData.mode; }
-
-        if (newRow) { std::copy_backward(waterfall.begin(), waterfall.end() - SPEC_W * 4, waterfall.end()); std::copy(row.begin(), row.end(), waterfall.begin()); wTex.update(waterfall.data()); }
+        if (pendingTuneHz >= 0) { sendCommand({CommandType::TUNE, pendingTuneHz}); pendingTuneHz = -1; }
+        if (pendingSeek >= 0.0) { sendCommand({CommandType::SEEK, 0, pendingSeek}); pendingSeek = -1.0; }
+
+        // Publish a new control snapshot only when something changed
+        publishParams();
+        double tunePct = uiParams.tunedFreqPercent; Mode mode = currentMode;
+
+        sharedData.spectrumFrames.update();
+        sharedData.rxStatus.update();
+        const std::vector<double>& spectrum = sharedData.spectrumFrames.readBuffer().spectrum;
+
+        // Drain every queued row; rows that would scroll off screen right away are skipped.
+        // Each upload is a single row; scrolling is done by moving the split point in the draw below.
+        for (size_t pending = sharedData.waterfallRows.available(); pending > WATERFALL_H; pending--) sharedData.waterfallRows.popFront();
+        while (WaterfallRow* row = sharedData.waterfallRows.front()) {
+            wHead = (wHead + WATERFALL_H - 1) % WATERFALL_H;
+            wTex.update(row->pixels.data(), {(unsigned)SPEC_W, 1u}, {0u, (unsigned)wHead});
+            wRowTime[wHead] = row->timestamp;
+            sharedData.waterfallRows.popFront();
+        }
 
         window.clear(sf::Color::Black);
         long long cf = 0; double sr = 2e6; { std::lock_guard<std::mutex> l(sourceMtx); if (currentSource) { sr = currentSource->getSampleRate(); } } if (currentSource) cf = currentCenterFreq;
@@ -805,16 +1087,60 @@ int main() {
 
         sf::VertexArray lines(sf::PrimitiveType::Lines, spectrum.size());
         for (size_t i = 0; i < spectrum.size(); i++) { float norm = (spectrum[i] - minDbSlider.currentVal) / (maxDbSlider.currentVal - minDbSlider.currentVal); float y = SPEC_H - (norm * SPEC_H); if (y < 0) y = 0; if (y > SPEC_H) y = SPEC_H; lines[i].position = { (float)i / spectrum.size() * SPEC_W, y + TOP_BAR_H }; lines[i].color = sf::Color::Cyan; }
-        window.draw(lines); window.draw(wSpr); 
+        window.draw(lines);
+
+        const ReceiverStatus& rxStatus = sharedData.rxStatus.readBuffer();
+        if (rxStatus.stereo) {
+            sf::Text stereoLabel(font, "STEREO", 12); stereoLabel.setPosition({(float)SPEC_W - 60, (float)TOP_BAR_H + 5}); stereoLabel.setFillColor(sf::Color::Green); window.draw(stereoLabel);
+        }
+        // RDS of the main VFO: PI and station name on the first line, RadioText and clock below
+        if (rxStatus.rds.hasPi) {
+            char line[96]; std::snprintf(line, sizeof(line), "RDS %04X  %s", rxStatus.rds.pi, rxStatus.rds.ps);
+            sf::Text rdsLabel(font, line, 12); rdsLabel.setPosition({40.f, (float)TOP_BAR_H + 5}); rdsLabel.setFillColor(sf::Color::Yellow); window.draw(rdsLabel);
+            std::string text(rxStatus.rds.rt);
+            text.erase(text.find_last_not_of(' ') + 1);
+            if (rxStatus.rds.ct[0]) text += std::string(text.empty() ? "" : "   ") + rxStatus.rds.ct;
+            if (!text.empty()) { sf::Text rtLabel(font, text, 12); rtLabel.setPosition({40.f, (float)TOP_BAR_H + 20}); rtLabel.setFillColor(sf::Color::Yellow); window.draw(rtLabel); }
+        }
+
+        // Waterfall in two draws: rows [wHead, H) on top, then the wrapped rows [0, wHead) below them
+        int wTopRows = WATERFALL_H - wHead;
+        wSprTop.setTextureRect(sf::IntRect({0, wHead}, {SPEC_W, wTopRows})); wSprTop.setPosition({0, (float)SPEC_H + TOP_BAR_H});
+        window.draw(wSprTop);
+        if (wHead > 0) { wSprBottom.setTextureRect(sf::IntRect({0, 0}, {SPEC_W, wHead})); wSprBottom.setPosition({0, (float)SPEC_H + TOP_BAR_H + wTopRows}); window.draw(wSprBottom); }
+
+        // Waterfall time axis from the row timestamps, labelled with age relative to the newest row
+        if (wRowTime[wHead] >= 0) {
+            double newest = wRowTime[wHead];
+            double span = WATERFALL_H / std::max(wfSpeedSlider.currentVal, 1.0f);
+            double tickSec = 60.0;
+            for (double step : {1.0, 2.0, 5.0, 10.0, 30.0}) { if (span / step <= 8.0) { tickSec = step; break; } }
+            double nextTick = tickSec;
+            for (int r = 1; r < WATERFALL_H; r++) {
+                double t = wRowTime[(wHead + r) % WATERFALL_H];
+                if (t < 0) break;
+                if (newest - t < nextTick) continue;
+                float yPos = (float)(SPEC_H + TOP_BAR_H + r);
+                sf::RectangleShape tick({8, 1}); tick.setPosition({0, yPos}); tick.setFillColor(sf::Color::White); window.draw(tick);
+                sf::Text l(font, "-" + std::to_string((int)nextTick) + "s", 10); l.setPosition({10, yPos - 6}); l.setFillColor(sf::Color::White); window.draw(l);
+                nextTick = (std::floor((newest - t) / tickSec) + 1.0) * tickSec;
+            }
+        }
 
-        float mouseX = -1.0f; float mouseY = -1.0f; { std::lock_guard<std::mutex> lock(sharedData.mtx); mouseX = sharedData.mouseX_spectrum; mouseY = sharedData.mouseY_spectrum; }
         if (mouseX != -1.0f) { sf::Color guideColor(100, 100, 100); sf::VertexArray lineFFT(sf::PrimitiveType::Lines, 2); lineFFT[0].position = {mouseX, (float)TOP_BAR_H}; lineFFT[0].color = guideColor; lineFFT[1].position = {mouseX, (float)SPEC_H + TOP_BAR_H}; lineFFT[1].color = guideColor; window.draw(lineFFT); if (mouseY > (float)SPEC_H) { sf::VertexArray lineWaterfall(sf::PrimitiveType::Lines, 2); lineWaterfall[0].position = {mouseX, (float)SPEC_H + TOP_BAR_H}; lineWaterfall[0].color = guideColor; lineWaterfall[1].position = {mouseX, (float)(SPEC_H + WATERFALL_H + TOP_BAR_H)}; lineWaterfall[1].color = guideColor; window.draw(lineWaterfall); } }
 
         sf::RectangleShape tunerRect; float bwPixels = (bwSlider.currentVal / sr) * SPEC_W; if (bwPixels < 2.0f) bwPixels = 2.0f;
-        float rectX = tunePct * SPEC_W - bwPixels / 2.0f; if (mode == Mode::USB) rectX += bwPixels / 2.0f; if (mode == Mode::LSB) rectX -= bwPixels / 2.0f;
+        float rectX = (float)((tunePct + Demodulator::passbandCenter(mode, bwSlider.currentVal) / sr) * SPEC_W) - bwPixels / 2.0f;
         tunerRect.setSize({bwPixels, (float)SPEC_H}); tunerRect.setPosition({rectX, (float)TOP_BAR_H});
         tunerRect.setFillColor(mode == Mode::OFF ? sf::Color(50, 50, 50, 40) : sf::Color(200, 200, 200, 50)); tunerRect.setOutlineThickness(0); window.draw(tunerRect);
 
+        for (const VfoSettings& v : uiParams.extraVfos) {
+            float vw = std::max((float)(v.bandwidthHz / sr * SPEC_W), 2.0f);
+            float vx = (float)(((double)(v.freqHz - cf + Demodulator::passbandCenter(v.mode, v.bandwidthHz, v.passbandLowHz)) / sr + 0.5) * SPEC_W) - vw / 2.0f;
+            sf::RectangleShape vfoRect({vw, (float)SPEC_H}); vfoRect.setPosition({vx, (float)TOP_BAR_H}); vfoRect.setFillColor(sf::Color(230, 180, 40, 50)); window.draw(vfoRect);
+            sf::Text vfoLabel(font, "V" + std::to_string(v.id), 10); vfoLabel.setPosition({vx + 2, (float)TOP_BAR_H + 2}); vfoLabel.setFillColor(sf::Color(230, 180, 40)); window.draw(vfoLabel);
+        }
+
         sf::VertexArray centerLine(sf::PrimitiveType::Lines, 2); float centerX = tunePct * SPEC_W;
         centerLine[0].position = {centerX, (float)TOP_BAR_H}; centerLine[0].color = sf::Color::Red; centerLine[1].position = {centerX, (float)SPEC_H + TOP_BAR_H}; centerLine[1].color = sf::Color::Red; window.draw(centerLine);
 
@@ -823,18 +1149,33 @@ int main() {
         freqVFO.draw(window); btnPlay.draw(window);
 
         // Draw Controls
-        rfGainSlider.draw(window); btnAgc.draw(window);
+        rfGainSlider.draw(window); btnAgc.draw(window); btnIqCorr.draw(window);
 
         bwSlider.draw(window); minDbSlider.draw(window); maxDbSlider.draw(window);
-        btnNFM.draw(window); btnAM.draw(window); btnWFM.draw(window); btnOFF.draw(window); btnLSB.draw(window); btnUSB.draw(window);
+        btnNFM.draw(window); btnAM.draw(window); btnWFM.draw(window); btnOFF.draw(window); btnLSB.draw(window); btnUSB.draw(window); btnCW.draw(window); btnSAM.draw(window); btnSamSide.draw(window);
+        btnStereo.draw(window); btnDeemph.draw(window); btnAudioAgc.draw(window);
+        sqlSlider.draw(window); btnTone.draw(window); btnNb.draw(window); btnNr.draw(window); btnAnf.draw(window); btnDisc.draw(window);
+        {
+            char toneBuf[64];
+            if (uiParams.ctcssHz > 0.0f) std::snprintf(toneBuf, sizeof(toneBuf), "Tone CTCSS %.1f Hz", uiParams.ctcssHz);
+            else if (uiParams.dcsCode > 0) std::snprintf(toneBuf, sizeof(toneBuf), "Tone DCS %03o", uiParams.dcsCode);
+            else if (rxStatus.ctcssHz > 0.0f) std::snprintf(toneBuf, sizeof(toneBuf), "Rx CTCSS %.1f Hz", rxStatus.ctcssHz);
+            else if (rxStatus.dcsCode > 0) std::snprintf(toneBuf, sizeof(toneBuf), "Rx DCS %03o", rxStatus.dcsCode);
+            else std::snprintf(toneBuf, sizeof(toneBuf), "%.0f dBFS", rxStatus.powerDb);
+            toneText.setString(toneBuf);
+            toneText.setFillColor(rxStatus.squelchOpen ? sf::Color::Green : sf::Color(150, 150, 150));
+            window.draw(toneText);
+        }
 
         // Draw Recording Panel
         window.draw(recPanel);
         window.draw(labelRec);
-        btnRecAudio.draw(window); btnRecIQ.draw(window);
+        btnRecAudio.draw(window); btnRecIQ.draw(window); btnRecChannels.draw(window);
         window.draw(pathText);
         btnSelectFolder.draw(window);
         btnRecStart.draw(window);
+        wfSpeedSlider.draw(window);
+        btnVfoAdd.draw(window); btnVfoDel.draw(window); btnVfoOut.draw(window);
 
         if (audioDropdown.isOpen) audioDropdown.draw(window);
         if (rateDropdown.isOpen) rateDropdown.draw(window);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "DSP.h"
+#include <vector>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+// Minimal checks for the DSP tests: every failed CHECK is printed, the test returns
+// testResult() (non-zero after any failure)
+inline int& failedChecks() { static int failed = 0; return failed; }
+
+#define CHECK(cond) do { \
+        if (!(cond)) { std::printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond); failedChecks()++; } \
+    } while (0)
+
+inline int testResult(const char* name) {
+    std::printf("%s: %s\n", name, failedChecks() == 0 ? "OK" : "FAILED");
+    return failedChecks() == 0 ? 0 : 1;
+}
+
+// FM modulated tone plus complex white noise: deviation and tone in Hz, noise as an rms level
+inline std::vector<Complex> fmTone(size_t n, double sampleRate, double carrierHz, double toneHz, double deviationHz,
+                                   double noiseRms = 0.0, double amplitude = 0.5, unsigned seed = 1) {
+    std::vector<Complex> iq(n);
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> gauss(0.0, noiseRms / std::sqrt(2.0));
+    double phase = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double f = carrierHz + deviationHz * std::sin(2.0 * PI * toneHz * i / sampleRate);
+        phase += 2.0 * PI * f / sampleRate;
+        iq[i] = std::polar(amplitude, phase) + (noiseRms > 0.0 ? Complex(gauss(rng), gauss(rng)) : Complex(0, 0));
+    }
+    return iq;
+}
+
+// SINAD (dB) of a tone at toneHz: least squares fit of sin / cos / DC, residual = noise + distortion
+inline double toneSinadDb(const float* x, size_t n, double sampleRate, double toneHz) {
+    double ss = 0, sc = 0, cc = 0, xs = 0, xc = 0, mean = 0;
+    for (size_t i = 0; i < n; i++) mean += x[i];
+    mean /= n;
+    for (size_t i = 0; i < n; i++) {
+        double s = std::sin(2.0 * PI * toneHz * i / sampleRate), c = std::cos(2.0 * PI * toneHz * i / sampleRate);
+        ss += s * s; sc += s * c; cc += c * c; xs += (x[i] - mean) * s; xc += (x[i] - mean) * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (xs * cc - xc * sc) / det, b = (xc * ss - xs * sc) / det;
+    double signal = 0, residual = 0;
+    for (size_t i = 0; i < n; i++) {
+        double fit = a * std::sin(2.0 * PI * toneHz * i / sampleRate) + b * std::cos(2.0 * PI * toneHz * i / sampleRate);
+        double r = x[i] - mean - fit;
+        signal += fit * fit; residual += r * r;
+    }
+    return 10.0 * std::log10(signal / (residual + 1e-30));
+}
+
+// rms level
+inline double rms(const float* x, size_t n) {
+    double s = 0;
+    for (size_t i = 0; i < n; i++) s += (double)x[i] * x[i];
+    return std::sqrt(s / std::max<size_t>(n, 1));
+}
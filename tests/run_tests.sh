@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Builds and runs the DSP tests (no SFML / rtl-sdr needed).
+# Usage: tests/run_tests.sh [test_name ...]
+
+cd "$(dirname "$0")"
+CXX="${CXX:-g++}"
+FLAGS="-std=c++17 -O2 -Wall -I../src"
+LIBS="-ldl -lpthread -lm"
+mkdir -p build
+
+TESTS="$@"
+if [ -z "$TESTS" ]; then TESTS=$(ls test_*.cpp | sed 's/\.cpp$//'); fi
+
+FAILED=0
+for t in $TESTS; do
+    EXTRA=""
+    # The Q15 kernels are only compiled with the fixed-point build. Only an ARM build checks
+    # the NEON kernels against their scalar references; elsewhere both are the scalar code.
+    if [ "$t" == "test_fixed_point" ]; then EXTRA="-DENABLE_FIXED_POINT"; fi
+
+    if ! $CXX $FLAGS $EXTRA $t.cpp -o build/$t $LIBS; then
+        echo "$t: BUILD FAILED"; FAILED=1; continue
+    fi
+    ./build/$t || FAILED=1
+done
+
+echo "------------------------------------------"
+if [ $FAILED -eq 0 ]; then echo "ALL TESTS PASSED"; else echo "SOME TESTS FAILED"; fi
+exit $FAILED
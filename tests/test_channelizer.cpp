@@ -0,0 +1,46 @@
+// Channelizer: a tone in channel k comes out of channel k only
+#include "Channelizer.h"
+#include "TestUtil.h"
+
+// Power per channel (dB) of a tone at offsetHz, after the filter has settled
+static std::vector<double> channelPowers(Channelizer& ch, double sampleRate, double offsetHz) {
+    const size_t n = 200000;
+    std::vector<Complex> iq(n);
+    for (size_t i = 0; i < n; i++) iq[i] = std::polar(0.5, 2.0 * PI * offsetHz * i / sampleRate);
+
+    size_t stride = ch.maxOutput(n);
+    std::vector<Complex> out(ch.numChannels() * stride);
+    size_t frames = ch.process(iq.data(), n, out.data(), stride);
+
+    std::vector<double> db(ch.numChannels());
+    for (size_t k = 0; k < ch.numChannels(); k++) {
+        double p = 0.0;
+        for (size_t j = frames / 4; j < frames; j++) p += std::norm(out[k * stride + j]);
+        db[k] = 10.0 * std::log10(p / (frames - frames / 4) + 1e-30);
+    }
+    return db;
+}
+
+static void checkTone(size_t channels, size_t decimation, double sampleRate, size_t k, double detuneHz) {
+    Channelizer ch(channels, decimation);
+    double offset = ch.channelCenter(k, sampleRate) + detuneHz;
+    CHECK(ch.channelFor(offset, sampleRate) == k);
+
+    std::vector<double> db = channelPowers(ch, sampleRate, offset);
+    double worst = -300.0;
+    for (size_t j = 0; j < channels; j++) if (j != k) worst = std::max(worst, db[j]);
+    std::printf("  %zu channels / %zu, tone %+.0f Hz: channel %zu at %.1f dB, others <= %.1f dB\n",
+                channels, decimation, offset, k, db[k], worst);
+    CHECK(db[k] > -10.0);          // the tone (-6 dBFS) passes
+    CHECK(db[k] - worst > 50.0);   // and nowhere else
+}
+
+int main() {
+    const double rate = 1600000.0;
+    checkTone(16, 16, rate, 3, 0.0);        // critically sampled
+    checkTone(16, 8, rate, 3, 20000.0);     // oversampled, off center
+    checkTone(16, 8, rate, 13, -15000.0);   // negative frequency
+    checkTone(64, 32, 2400000.0, 1, 5000.0);
+    checkTone(64, 32, 2400000.0, 0, 0.0);
+    return testResult("test_channelizer");
+}
@@ -0,0 +1,76 @@
+// FM discriminators: accuracy against std::arg, audio SINAD through the NFM demodulator,
+// and a speed benchmark
+#include "Demodulator.h"
+#include "TestUtil.h"
+#include <chrono>
+
+static const char* typeName(DiscriminatorType t) {
+    return t == DiscriminatorType::Exact ? "Exact (std::arg)" : t == DiscriminatorType::Polynomial ? "Polynomial" : "CrossProduct";
+}
+static const DiscriminatorType TYPES[] = {DiscriminatorType::Exact, DiscriminatorType::Polynomial, DiscriminatorType::CrossProduct};
+
+// Largest deviation from std::arg over phase steps up to maxStep (noise free, unit circle and scaled)
+static double maxError(DiscriminatorType type, double maxStep) {
+    double worst = 0.0;
+    for (int i = -2000; i <= 2000; i++) {
+        double step = maxStep * i / 2000.0;
+        for (double a : {0.0, 1.0, 2.5, -2.0}) {
+            Complex prev = std::polar(0.7, a), z = std::polar(1.3, a + step);
+            worst = std::max(worst, std::fabs(phaseStep(type, z, prev) - std::arg(z * std::conj(prev))));
+        }
+    }
+    return worst;
+}
+
+// Audio SINAD of a 1 kHz tone, NFM (2.5 kHz deviation) at 240 kS/s with the given carrier to noise ratio
+static double nfmSinad(DiscriminatorType type, double cnrDb) {
+    const double rate = 240000.0;
+    std::vector<Complex> iq = fmTone(240000, rate, 0.0, 1000.0, 2500.0, 0.5 * std::pow(10.0, -cnrDb / 20.0));
+    Demodulator demod(rate, 48000.0);
+    demod.configure(0.0, 12500.0, Mode::NFM, 1.0f);
+    demod.setDiscriminator(type);
+    AgcSettings agc; agc.enabled = false;
+    demod.setAgc(agc);
+    std::vector<float> audio(demod.maxOutput(iq.size()));
+    size_t n = demod.process(iq.data(), iq.size(), audio.data(), audio.size());
+    return toneSinadDb(audio.data() + n / 4, n - n / 4, 48000.0, 1000.0); // after settling
+}
+
+// ns per sample of discriminate() over a WFM-like block
+static double benchmark(DiscriminatorType type) {
+    std::vector<Complex> iq = fmTone(1 << 16, 2400000.0, 0.0, 1000.0, 75000.0, 0.05);
+    std::vector<double> out(iq.size());
+    Complex last(1.0, 0.0);
+    volatile double sink = 0.0; // the compiler must keep every pass
+    const int reps = 100;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        discriminate(type, iq.data(), iq.size(), last, out.data());
+        sink = sink + out[r];
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return 1e9 * s / (reps * (double)iq.size());
+}
+
+int main() {
+    // Accuracy: Polynomial everywhere, CrossProduct for the small steps it's meant for
+    double polyError = maxError(DiscriminatorType::Polynomial, 3.1);
+    double crossError = maxError(DiscriminatorType::CrossProduct, 0.3);
+    std::printf("  max error vs std::arg: Polynomial %.2e rad (+-3.1), CrossProduct %.2e rad (+-0.3)\n", polyError, crossError);
+    CHECK(polyError < 1.2e-5);
+    CHECK(crossError < 2e-3);
+
+    // SINAD through the demodulator: the fast detectors must cost (next to) nothing
+    for (double cnr : {30.0, 15.0}) {
+        double exact = nfmSinad(DiscriminatorType::Exact, cnr);
+        for (DiscriminatorType t : TYPES) {
+            double sinad = nfmSinad(t, cnr);
+            std::printf("  NFM, CNR %2.0f dB: %-16s SINAD %5.2f dB (%+.2f dB vs std::arg)\n", cnr, typeName(t), sinad, sinad - exact);
+            if (t == DiscriminatorType::Polynomial) CHECK(std::fabs(sinad - exact) < 0.05);
+            if (t == DiscriminatorType::CrossProduct) CHECK(sinad > exact - 1.0);
+        }
+    }
+
+    for (DiscriminatorType t : TYPES) std::printf("  benchmark: %-16s %6.2f ns/sample\n", typeName(t), benchmark(t));
+    return testResult("test_discriminator");
+}
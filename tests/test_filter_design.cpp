@@ -0,0 +1,123 @@
+// Filter designs against their specs (equiripple, half-band, Hilbert, root-raised-cosine)
+// and the FilterCache hit / LRU behaviour
+#include "FilterDesign.h"
+#include "TestUtil.h"
+
+// Frequency response at f (cycles per sample), the linear-phase delay (taps - 1) / 2 removed
+static Complex response(const std::vector<double>& h, double f) {
+    double mid = (h.size() - 1) / 2.0;
+    Complex sum(0.0, 0.0);
+    for (size_t i = 0; i < h.size(); i++) sum += h[i] * std::polar(1.0, -2.0 * PI * f * (i - mid));
+    return sum;
+}
+
+// Largest pass-band deviation from 1 and largest stop-band gain, over a dense grid
+static void bandErrors(const std::vector<double>& h, double passEdge, double stopEdge, double& passDev, double& stopGain) {
+    passDev = 0.0; stopGain = 0.0;
+    for (int i = 0; i <= 2000; i++) {
+        double f = 0.5 * i / 2000.0;
+        double a = std::abs(response(h, f));
+        if (f <= passEdge) passDev = std::max(passDev, std::abs(a - 1.0));
+        if (f >= stopEdge) stopGain = std::max(stopGain, a);
+    }
+}
+
+static void testEquiripple() {
+    // Equal weights: both bands at least as good as a Kaiser window of the same length
+    // (equal ripple in both bands, attenuation 2.285 * 2 pi * transition * (N - 1) + 7.95 dB)
+    const size_t taps = 61;
+    const double passEdge = 0.1, stopEdge = 0.15;
+    double kaiserDb = 2.285 * 2.0 * PI * (stopEdge - passEdge) * (taps - 1) + 7.95;
+    double kaiserRipple = std::pow(10.0, -kaiserDb / 20.0);
+
+    double passDev, stopGain;
+    bandErrors(designEquiripple(taps, passEdge, stopEdge), passEdge, stopEdge, passDev, stopGain);
+    std::printf("  equiripple %zu taps: pass ripple %.2e, stop %.1f dB (Kaiser window: %.2e, %.1f dB)\n",
+                taps, passDev, -20.0 * std::log10(stopGain), kaiserRipple, kaiserDb);
+    CHECK(passDev <= kaiserRipple);
+    CHECK(-20.0 * std::log10(stopGain) >= kaiserDb);
+    CHECK(std::fabs(passDev / stopGain - 1.0) < 0.1); // equal ripple
+
+    // stopWeight 10: the stop band ripple is a tenth of the pass band ripple
+    bandErrors(designEquiripple(taps, passEdge, stopEdge, 10.0), passEdge, stopEdge, passDev, stopGain);
+    std::printf("  equiripple weight 10: pass ripple %.2e, stop %.1f dB\n", passDev, -20.0 * std::log10(stopGain));
+    CHECK(std::fabs(passDev / stopGain / 10.0 - 1.0) < 0.1);
+}
+
+static void testHalfband() {
+    for (size_t taps : {11, 31, 64}) {
+        std::vector<double> h = designHalfband(taps);
+        size_t mid = (h.size() - 1) / 2;
+        CHECK(h.size() % 4 == 3);
+        CHECK(h[mid] == 0.5);
+        size_t nonZero = 0;
+        for (size_t i = 0; i < h.size(); i++) {
+            size_t d = i > mid ? i - mid : mid - i;
+            if (d != 0 && d % 2 == 0) CHECK(h[i] == 0.0);
+            else nonZero += h[i] != 0.0;
+        }
+        CHECK(nonZero == (h.size() + 1) / 2 + 1);
+        CHECK(std::fabs(std::abs(response(h, 0.0)) - 1.0) < 1e-12);
+        CHECK(std::fabs(std::abs(response(h, 0.25)) - 0.5) < 1e-12); // half-band symmetry
+    }
+}
+
+static void testHilbert() {
+    // 90 degrees (-j for positive frequencies) with unit magnitude, away from 0 and Nyquist
+    std::vector<double> h = designHilbert(101);
+    double worstMag = 0.0, worstPhase = 0.0;
+    for (double f = 0.05; f <= 0.45; f += 0.001) {
+        Complex r = response(h, f);
+        worstMag = std::max(worstMag, std::abs(std::abs(r) - 1.0));
+        worstPhase = std::max(worstPhase, std::abs(std::arg(r) * 180.0 / PI + 90.0));
+    }
+    std::printf("  Hilbert 101 taps, 0.05..0.45: magnitude error %.2e, phase error %.2e deg\n", worstMag, worstPhase);
+    CHECK(worstMag < 1e-4);
+    CHECK(worstPhase < 1e-6);
+}
+
+static void testRootRaisedCosine() {
+    // Matched pair = raised cosine: 1 at the symbol instant, zero at every other one (no ISI)
+    const int sps = 8;
+    for (double rolloff : {0.2, 0.35, 0.5}) {
+        std::vector<double> h = designRootRaisedCosine(sps, rolloff, 16);
+        std::vector<double> p(2 * h.size() - 1, 0.0);
+        for (size_t i = 0; i < h.size(); i++) for (size_t j = 0; j < h.size(); j++) p[i + j] += h[i] * h[j];
+        size_t mid = h.size() - 1;
+        double isi = 0.0;
+        for (size_t k = sps; k <= mid; k += sps) isi = std::max({isi, std::abs(p[mid + k]), std::abs(p[mid - k])});
+        std::printf("  RRC rolloff %.2f: peak %.4f, worst ISI %.1e\n", rolloff, p[mid], isi);
+        CHECK(std::fabs(p[mid] - 1.0) < 1e-12); // unit energy
+        CHECK(isi < 1e-2); // truncated to 16 symbols: -40 dB at the smallest rolloff
+    }
+}
+
+static void testFilterCache() {
+    auto spec = [](double cutoffHz) { return FilterSpec{48000.0, cutoffHz, 4000.0, 40.0}; };
+
+    // Same key (cutoff rounded to 1 Hz): the same design comes back
+    FilterCache::Taps first = FilterCache::lowpass(spec(1000.0));
+    CHECK(FilterCache::lowpass(spec(1000.0)) == first);
+    CHECK(FilterCache::lowpass(spec(1000.3)) == first);
+    CHECK(FilterCache::lowpass(spec(1001.0)) != first);
+
+    // CAPACITY other designs, the second one kept in use: the first is evicted, the used one stays
+    FilterCache::Taps used = FilterCache::lowpass(spec(2000.0));
+    for (size_t i = 0; i < FilterCache::CAPACITY; i++) {
+        FilterCache::lowpass(spec(3000.0 + i));
+        CHECK(FilterCache::lowpass(spec(2000.0)) == used);
+    }
+    CHECK(FilterCache::lowpass(spec(2000.0)) == used);
+    FilterCache::Taps again = FilterCache::lowpass(spec(1000.0));
+    CHECK(again != first);
+    CHECK(*again == *first); // redesigned, identical
+}
+
+int main() {
+    testEquiripple();
+    testHalfband();
+    testHilbert();
+    testRootRaisedCosine();
+    testFilterCache();
+    return testResult("test_filter_design");
+}
@@ -0,0 +1,79 @@
+// FirFilter: direct form and overlap-save against a plain convolution, for tap counts on both
+// sides of DIRECT_MAX_TAPS and blocks that don't line up with the FFT; no step where setTaps()
+// crossfades to new taps
+#include "FirFilter.h"
+#include "FilterDesign.h"
+#include "TestUtil.h"
+
+static std::vector<Complex> noise(size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> gauss(0.0, 0.5);
+    std::vector<Complex> x(n);
+    for (auto& v : x) v = Complex(gauss(rng), gauss(rng));
+    return x;
+}
+
+// Streams x through the filter in blocks of the given sizes (cycled)
+static std::vector<Complex> run(FirFilter& f, const std::vector<Complex>& x, const std::vector<size_t>& blocks) {
+    std::vector<Complex> y(x.size());
+    for (size_t start = 0, b = 0; start < x.size(); b++) {
+        size_t n = std::min(blocks[b % blocks.size()], x.size() - start);
+        f.process(x.data() + start, y.data() + start, n);
+        start += n;
+    }
+    return y;
+}
+
+static void checkAgainstConvolution(size_t numTaps) {
+    std::vector<double> h = designLowpass(numTaps, 0.1, WindowType::Kaiser, kaiserBeta(60.0));
+    FirFilter f(numTaps);
+    f.setTaps(h.data());
+    CHECK(f.isDirect() == (numTaps <= FirFilter::DIRECT_MAX_TAPS));
+
+    std::vector<Complex> x = noise(30000, (unsigned)numTaps);
+    std::vector<Complex> y = run(f, x, {1, 37, 1000, 4099});
+
+    // latency() is the group delay plus, for overlap-save, one hop of buffering. The start
+    // is skipped: the filter fades in from its initial pure delay.
+    size_t shift = f.latency() - (numTaps - 1) / 2;
+    double worst = 0.0;
+    for (size_t i = 10000; i < x.size(); i++) {
+        Complex ref(0.0, 0.0);
+        for (size_t j = 0; j < numTaps; j++) ref += h[j] * x[i - shift - j];
+        worst = std::max(worst, std::abs(y[i] - ref));
+    }
+    std::printf("  %4zu taps (%s): max error %.1e\n", numTaps, f.isDirect() ? "direct" : "overlap-save", worst);
+    CHECK(worst < 1e-9);
+}
+
+// A slow tone; halfway the taps switch to half the gain. A hard switch would jump by half the
+// amplitude, the crossfade must keep every step close to the tone's own slope.
+static void checkCrossfade(size_t numTaps) {
+    std::vector<double> h = designLowpass(numTaps, 0.1, WindowType::Kaiser, kaiserBeta(60.0));
+    std::vector<double> half(h);
+    for (double& v : half) v *= 0.5;
+
+    const size_t n = 40000, switchAt = 20000;
+    const double toneStep = 2.0 * PI * 0.002;
+    std::vector<Complex> x(n);
+    for (size_t i = 0; i < n; i++) x[i] = std::polar(1.0, toneStep * i);
+
+    FirFilter f(numTaps);
+    f.setTaps(h.data());
+    std::vector<Complex> y(n);
+    f.process(x.data(), y.data(), switchAt);
+    f.setTaps(half.data());
+    f.process(x.data() + switchAt, y.data() + switchAt, n - switchAt);
+
+    double worstStep = 0.0;
+    for (size_t i = switchAt - 1000; i < switchAt + 10000; i++) worstStep = std::max(worstStep, std::abs(y[i] - y[i - 1]));
+    std::printf("  %4zu taps: largest step across the crossfade %.4f (tone alone %.4f)\n", numTaps, worstStep, toneStep);
+    CHECK(worstStep < 1.2 * toneStep);
+    CHECK(std::fabs(std::abs(y[n - 1]) - 0.5) < 1e-3); // the new taps are in
+}
+
+int main() {
+    for (size_t taps : {15, 63, 64, 65, 127, 511, 1001}) checkAgainstConvolution(taps);
+    for (size_t taps : {63, 511}) checkCrossfade(taps);
+    return testResult("test_fir_filter");
+}
@@ -0,0 +1,160 @@
+// Q15 NFM path (built with -DENABLE_FIXED_POINT): every NEON kernel against its scalar
+// ...Reference twin (bit-identical on ARM, the same code elsewhere), the integer atan2
+// against libm, and the whole Q15 NFM output against the float NFM kernel
+#include "Demodulator.h"
+#include "TestUtil.h"
+#include <cstring>
+
+static std::mt19937 rng(7);
+
+// Random Q15 values; `extremes` of them are -32768 / 32767 to hit the saturation paths
+static std::vector<int16_t> randomQ15(size_t n, double extremes = 0.1, int16_t maxAbs = 32767) {
+    std::uniform_int_distribution<int> value(-maxAbs - 1, maxAbs);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::vector<int16_t> v(n);
+    for (auto& x : v) x = u(rng) < extremes ? (u(rng) < 0.5 ? (int16_t)(-maxAbs - 1) : maxAbs) : (int16_t)value(rng);
+    return v;
+}
+
+static void testConvert() {
+    Complex in[] = {{0.0, -0.0}, {1.0, -1.0}, {2.0, -3.0}, {0.5, -0.5}, {1.0 / 32768, -1.5 / 32768}};
+    int16_t re[5], im[5];
+    convertToQ15(in, re, im, 5);
+    CHECK(re[0] == 0 && im[0] == 0);
+    CHECK(re[1] == 32767 && im[1] == -32768); // saturated
+    CHECK(re[2] == 32767 && im[2] == -32768);
+    CHECK(re[3] == 16384 && im[3] == -16384);
+    CHECK(re[4] == 1 && im[4] == -1);
+}
+
+static void testComplexMul() {
+    for (size_t n : {1, 7, 8, 64, 1003}) {
+        std::vector<int16_t> re = randomQ15(n), im = randomQ15(n);
+        std::vector<int16_t> c = randomQ15(n, 0.2, 32767), s = randomQ15(n, 0.2, 32767); // |c|, |s| <= 32767
+        for (auto& x : c) x = std::max<int16_t>(x, -32767);
+        for (auto& x : s) x = std::max<int16_t>(x, -32767);
+        std::vector<int16_t> re2 = re, im2 = im;
+        complexMulQ15(re.data(), im.data(), c.data(), s.data(), n);
+        complexMulQ15Reference(re2.data(), im2.data(), c.data(), s.data(), n);
+        CHECK(re == re2);
+        CHECK(im == im2);
+    }
+    // (-1 - j) * (1 + j) * 32767^2: both parts saturate
+    int16_t re = -32768, im = -32768, c = 32767, s = 32767;
+    complexMulQ15(&re, &im, &c, &s, 1);
+    CHECK(re == 0 && im == -32768);
+}
+
+static void testDot() {
+    for (size_t n : {8, 16, 128, 1024}) {
+        for (double extremes : {0.0, 0.5, 1.0}) { // 1.0: every product is +-2^30, the sum wraps
+            std::vector<int16_t> a = randomQ15(n, extremes), b = randomQ15(n, extremes);
+            CHECK(dotQ15(a.data(), b.data(), n) == dotQ15Reference(a.data(), b.data(), n));
+        }
+    }
+}
+
+static void testFirDecimator() {
+    std::vector<double> h = designLowpass(kaiserLength(5000.0 / 240000.0, 60.0), 6250.0 / 240000.0, WindowType::Kaiser, kaiserBeta(60.0));
+    // Full scale taps too, so outputs saturate
+    std::vector<double> loud(37, 0.9);
+    for (const std::vector<double>* taps : {&h, &loud}) {
+        FirDecimatorQ15 fir(*taps);
+        std::vector<int16_t> x = randomQ15(5000, 0.3);
+        size_t mismatches = 0, saturated = 0;
+        for (int16_t v : x) {
+            fir.push(v);
+            int16_t y = fir.output();
+            mismatches += y != fir.outputReference();
+            saturated += y == 32767 || y == -32768;
+        }
+        CHECK(mismatches == 0);
+        if (taps == &loud) CHECK(saturated > 0);
+    }
+
+    // New taps of the same length keep the delay line: same output as a filter that had them all along
+    std::vector<double> wide = designLowpass(h.size(), 8000.0 / 240000.0, WindowType::Kaiser, kaiserBeta(60.0));
+    FirDecimatorQ15 swapped(h), fresh(wide);
+    std::vector<int16_t> x = randomQ15(3000, 0.3);
+    size_t differ = 0;
+    for (size_t i = 0; i < x.size(); i++) {
+        if (i == 1000) swapped.setTaps(wide);
+        swapped.push(x[i]); fresh.push(x[i]);
+        if (i >= 1000) differ += swapped.output() != fresh.output();
+    }
+    CHECK(differ == 0);
+}
+
+static void testAtan2() {
+    // Binary angle: 32768 = pi. Error within a few LSB (fastAtan2: 1.2e-5 rad = 0.13 LSB, plus rounding)
+    int worst = 0;
+    std::uniform_int_distribution<int> v(-40000, 40000);
+    for (int i = 0; i < 200000; i++) {
+        int64_t y = v(rng), x = v(rng);
+        if (i < 8) { x = (i & 1) ? 32767 : -32768; y = (i & 2) ? 0 : (i & 4) ? 32767 : -32768; }
+        if (x == 0 && y == 0) continue;
+        int expected = (int)std::lround(std::atan2((double)y, (double)x) / PI * 32768.0);
+        int diff = (int16_t)(uint16_t)((atan2Q15(y, x) - expected) & 0xFFFF); // wraps like the angle
+        worst = std::max(worst, std::abs(diff));
+    }
+    std::printf("  atan2Q15: max error %d LSB (%.1e rad)\n", worst, worst * PI / 32768.0);
+    CHECK(worst <= 4);
+    CHECK(atan2Q15(0, 0) == 0);
+}
+
+// Q15 NFM against the float kernel on the same signal
+static void testNfmAgainstFloat() {
+    const double rate = 240000.0;
+    std::vector<Complex> iq = fmTone(240000, rate, 3000.0, 1000.0, 2500.0, 0.005);
+    std::vector<float> audio[2];
+    size_t count[2];
+    for (int fixed = 0; fixed < 2; fixed++) {
+        Demodulator demod(rate, 48000.0);
+        demod.configure(3000.0, 12500.0, Mode::NFM, 1.0f);
+        AgcSettings agc; agc.enabled = false;
+        demod.setAgc(agc);
+        demod.setFixedPointNfm(fixed == 1);
+        audio[fixed].resize(demod.maxOutput(iq.size()));
+        count[fixed] = 0;
+        for (size_t start = 0; start < iq.size(); start += 4000) { // stream in blocks
+            count[fixed] += demod.process(iq.data() + start, 4000, audio[fixed].data() + count[fixed], audio[fixed].size() - count[fixed]);
+        }
+    }
+    CHECK(count[0] == count[1]);
+    size_t n = std::min(count[0], count[1]), from = n / 4;
+    double sinadFloat = toneSinadDb(audio[0].data() + from, n - from, 48000.0, 1000.0);
+    double sinadFixed = toneSinadDb(audio[1].data() + from, n - from, 48000.0, 1000.0);
+    double levelDb = 20.0 * std::log10(rms(audio[1].data() + from, n - from) / rms(audio[0].data() + from, n - from));
+
+    // The filters differ (group delay too): compare at the best lag
+    double bestError = 1e30;
+    for (int lag = -40; lag <= 40; lag++) {
+        double e = 0.0, ref = 0.0;
+        for (size_t i = from; i + 40 < n; i++) {
+            double d = audio[1][i + lag] - audio[0][i];
+            e += d * d; ref += (double)audio[0][i] * audio[0][i];
+        }
+        bestError = std::min(bestError, 10.0 * std::log10(e / ref));
+    }
+    std::printf("  NFM: SINAD float %.1f dB, Q15 %.1f dB, level %+.2f dB, difference %.1f dB below the signal\n",
+                sinadFloat, sinadFixed, levelDb, -bestError);
+    CHECK(sinadFixed > 30.0);
+    CHECK(sinadFixed > sinadFloat - 3.0);
+    CHECK(std::fabs(levelDb) < 0.5);
+    CHECK(bestError < -20.0);
+}
+
+int main() {
+#if defined(__ARM_NEON)
+    std::printf("  NEON kernels against the scalar references\n");
+#else
+    std::printf("  no NEON: kernels are the scalar references (run on ARM for the NEON comparison)\n");
+#endif
+    testConvert();
+    testComplexMul();
+    testDot();
+    testFirDecimator();
+    testAtan2();
+    testNfmAgainstFloat();
+    return testResult("test_fixed_point");
+}
@@ -0,0 +1,65 @@
+// IqCorrection: a front end with a known DC offset and gain / phase imbalance; the estimates
+// must converge to it and the image of a test tone must be suppressed
+#include "IqCorrection.h"
+#include "TestUtil.h"
+
+static const double RATE = 250000.0;
+static const double TONE_HZ = 31250.0;      // rate / 8, image at -TONE_HZ
+static const Complex DC(0.05, -0.03);
+static const double GAIN_DB = 0.5, PHASE_DEG = 3.0;
+
+// Tone plus white noise through the impaired front end: Q' = gain (Q cos + I sin), then DC
+static std::vector<Complex> frontEnd(size_t n, unsigned seed) {
+    std::vector<Complex> iq = fmTone(n, RATE, TONE_HZ, 0.0, 0.0, 0.05, 0.5, seed);
+    double gain = std::pow(10.0, GAIN_DB / 20.0), phase = PHASE_DEG * PI / 180.0;
+    for (Complex& z : iq) {
+        double i = z.real(), q = z.imag();
+        z = Complex(i, gain * (q * std::cos(phase) + i * std::sin(phase))) + DC;
+    }
+    return iq;
+}
+
+// Tone over image power (dB), by correlation with both frequencies
+static double imageRejectionDb(const Complex* x, size_t n) {
+    Complex tone(0.0, 0.0), image(0.0, 0.0);
+    for (size_t i = 0; i < n; i++) {
+        Complex osc = std::polar(1.0, 2.0 * PI * TONE_HZ * i / RATE);
+        tone += x[i] * std::conj(osc);
+        image += x[i] * osc;
+    }
+    return 20.0 * std::log10(std::abs(tone) / std::abs(image));
+}
+
+int main() {
+    const size_t n = (size_t)(6.0 * RATE); // six imbalance time constants
+    const size_t measure = 65536;          // the tail, for the image rejection
+    std::vector<Complex> iq = frontEnd(n, 3);
+    double before = imageRejectionDb(iq.data() + n - measure, measure);
+
+    IqCorrection corr;
+    corr.setEnabled(true);
+    for (size_t start = 0; start < n; start += 10000) corr.process(iq.data() + start, std::min<size_t>(10000, n - start), RATE);
+
+    Complex dc = corr.dcOffset();
+    double after = imageRejectionDb(iq.data() + n - measure, measure);
+    Complex residualDc(0.0, 0.0);
+    for (size_t i = n - measure; i < n; i++) residualDc += iq[i];
+    residualDc /= (double)measure;
+
+    std::printf("  DC %.4f%+.4fj (injected %.4f%+.4fj), residual %.1e\n", dc.real(), dc.imag(), DC.real(), DC.imag(), std::abs(residualDc));
+    std::printf("  phase %.3f deg (injected %.3f), gain %.3f dB (injected %.3f)\n", corr.phaseErrorDeg(), PHASE_DEG, corr.gainErrorDb(), GAIN_DB);
+    std::printf("  image rejection %.1f dB -> %.1f dB\n", before, after);
+    CHECK(std::abs(dc - DC) < 1e-3);
+    CHECK(std::abs(residualDc) < 1e-3);
+    CHECK(std::fabs(corr.phaseErrorDeg() - PHASE_DEG) < 0.05);
+    CHECK(std::fabs(corr.gainErrorDb() - GAIN_DB) < 0.01);
+    CHECK(before < 35.0);
+    CHECK(after > 55.0);
+
+    // Disabled: samples pass untouched
+    IqCorrection off;
+    std::vector<Complex> raw = frontEnd(4096, 5), copy = raw;
+    off.process(copy.data(), copy.size(), RATE);
+    CHECK(copy == raw);
+    return testResult("test_iq_correction");
+}
@@ -0,0 +1,38 @@
+// VfoBank: output count per block, also after the input rate changes
+#define MINIAUDIO_IMPLEMENTATION
+#include "VfoBank.h"
+#include "TestUtil.h"
+
+static const double AUDIO_RATE = 48000.0;
+
+// Runs `blocks` blocks of sampleRate / 60 and checks every block returns all of its output
+static void runBlocks(VfoBank& bank, double sampleRate, int blocks) {
+    std::vector<VfoSettings> list(1);
+    list[0].freqHz = 100000000 + 10000;
+    list[0].mode = Mode::NFM;
+    bank.sync(list, 100000000, sampleRate);
+
+    size_t chunk = (size_t)sampleRate / 60;
+    int decimation = (int)(sampleRate / AUDIO_RATE);
+    std::vector<Complex> iq = fmTone(chunk, sampleRate, 10000.0, 1000.0, 2500.0, 0.01);
+    std::vector<float> left(bank.maxOutput(chunk)), right(bank.maxOutput(chunk));
+
+    size_t total = 0;
+    for (int b = 0; b < blocks; b++) {
+        size_t n = bank.process(iq.data(), chunk, left.data(), right.data(), left.size());
+        CHECK(n >= chunk / decimation);
+        total += n;
+    }
+    double perSecond = total * sampleRate / ((double)chunk * blocks);
+    std::printf("  %.0f S/s in: %zu samples per block, %.0f samples/s out\n", sampleRate, total / blocks, perSecond);
+    CHECK(std::fabs(perSecond - sampleRate / decimation) < sampleRate / decimation * 1e-3);
+}
+
+int main() {
+    ThreadPool pool(1);
+    VfoBank bank(pool, AUDIO_RATE);
+    runBlocks(bank, 2400000.0, 60);
+    runBlocks(bank, 1024000.0, 60); // smaller blocks but a lower decimation: more output per block
+    runBlocks(bank, 2048000.0, 60);
+    return testResult("test_vfobank");
+}